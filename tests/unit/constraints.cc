@@ -1,5 +1,7 @@
 #include <catch2/catch_all.hpp>
+#include <chrono>
 #include <ctime>
+#include <thread>
 
 #include "ttg.h"
 
@@ -48,18 +50,14 @@ TEST_CASE("constraints", "") {
     }, ttg::edges(), ttg::edges(e));
     bcast->set_keymap([&](){ return world.rank(); });
 
-    /**
-     * Constraints are currently only implemented in the PaRSEC backend.
-     * Codes using constraints will still compile but they will not
-     * affect the execution order in other backends.
-     */
-#ifdef TTG_USE_PARSEC
     make_graph_executable(bcast);
     ttg::execute(ttg::default_execution_context());
     bcast->invoke();
 
     ttg::ttg_fence(ttg::default_execution_context());
-#endif // TTG_USE_PARSEC
+    auto stats = constraint->stats();
+    CHECK(stats.pending == 0);
+    CHECK(stats.released == stats.deferred);
 
   }
 
@@ -96,18 +94,100 @@ TEST_CASE("constraints", "") {
     }, ttg::edges(), ttg::edges(e));
     bcast->set_keymap([&](){ return world.rank(); });
 
-    /**
-     * Constraints are currently only implemented in the PaRSEC backend.
-     * Codes using constraints will still compile but they will not
-     * affect the execution order in other backends.
-     */
-#ifdef TTG_USE_PARSEC
     make_graph_executable(bcast);
     ttg::execute(ttg::default_execution_context());
     bcast->invoke();
 
     ttg::ttg_fence(ttg::default_execution_context());
-#endif // TTG_USE_PARSEC
+    auto stats = constraint->stats();
+    CHECK(stats.pending == 0);
+    CHECK(stats.released == stats.deferred);
 
   }
+
+  SECTION("max-concurrency") {
+    ttg::Edge<Key, int> e;
+    auto world = ttg::default_execution_context();
+    std::atomic<int> active = 0;
+    std::atomic<int> executed = 0;
+    auto constraint = ttg::make_shared_constraint<ttg::MaxConcurrencyConstraint<Key>>(2);
+    auto tt = ttg::make_tt([&](const Key& key, const int& value){
+      int a = ++active;
+      CHECK(a <= 2);
+      ++executed;
+      --active;
+    }, ttg::edges(e), ttg::edges());
+    // every process executes all tasks
+    tt->set_keymap([&](const Key&){ return world.rank(); });
+    tt->add_constraint(constraint);
+
+    auto bcast = ttg::make_tt([&](){
+      std::vector<Key> keys;
+      for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 10; ++j) {
+          keys.push_back(Key{i, j});
+        }
+      }
+      ttg::broadcast<0>(std::move(keys), 0);
+    }, ttg::edges(), ttg::edges(e));
+    bcast->set_keymap([&](){ return world.rank(); });
+
+    make_graph_executable(bcast);
+    ttg::execute(ttg::default_execution_context());
+    bcast->invoke();
+
+    ttg::ttg_fence(ttg::default_execution_context());
+    CHECK(executed == 100);
+    CHECK(constraint->num_active() == 0);
+    CHECK(constraint->num_deferred() == 0);
+  }
+
+  SECTION("memory-budget") {
+    ttg::Edge<Key, int> e;
+    auto world = ttg::default_execution_context();
+    /* each active task holds one unit of memory */
+    std::atomic<std::size_t> usage = 0;
+    std::atomic<int> executed = 0;
+    std::size_t num_active_over_budget = 0, num_deferred_over_budget = 0;
+    auto constraint = ttg::make_shared_constraint<ttg::MemoryBudgetConstraint<Key>>(4, [&](){ return usage.load(); });
+    constraint->set_batch_size(2);
+    auto tt = ttg::make_tt([&](const Key& key, const int& value){
+      ++usage;
+      /* hold the memory for a while so that tasks overlap */
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      ++executed;
+      --usage;
+    }, ttg::edges(e), ttg::edges());
+    // every process executes all tasks
+    tt->set_keymap([&](const Key&){ return world.rank(); });
+    tt->add_constraint(constraint);
+
+    auto bcast = ttg::make_tt([&](){
+      std::vector<Key> keys;
+      for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 10; ++j) {
+          keys.push_back(Key{i, j});
+        }
+      }
+      /* exceed the budget while the keys are checked */
+      usage += 10;
+      ttg::broadcast<0>(std::move(keys), 0);
+      /* over budget, tasks are only admitted one at a time to guarantee progress */
+      num_active_over_budget = constraint->num_active();
+      num_deferred_over_budget = constraint->num_deferred();
+      usage -= 10;
+      constraint->release();
+    }, ttg::edges(), ttg::edges(e));
+    bcast->set_keymap([&](){ return world.rank(); });
+
+    make_graph_executable(bcast);
+    ttg::execute(ttg::default_execution_context());
+    bcast->invoke();
+
+    ttg::ttg_fence(ttg::default_execution_context());
+    CHECK(num_active_over_budget <= 1);
+    CHECK(num_deferred_over_budget > 0);
+    CHECK(executed == 100);
+    CHECK(constraint->num_deferred() == 0);
+  }
 }  // TEST_CASE("streams")
@@ -2,20 +2,57 @@
 
 #include "ttg.h"
 
+#include <chrono>
+#include <thread>
+
 #include "ttg/serialization/std/pair.h"
 #include "ttg/util/hash/std/pair.h"
 
 constexpr int64_t N = 1000;
 
+/* the distributed Fibonacci graph: fib tasks run on the last process and send the Fibonacci numbers
+ * to the reducing input of the result TT; fib task n runs its body through fib_fn(n, body) and
+ * result_fn is invoked with the sum */
+template <typename FibFn, typename ResultFn>
+auto make_fib_graph(FibFn &&fib_fn, ResultFn &&result_fn) {
+  ttg::Edge<int, std::pair<int, int>> F2F;
+  ttg::Edge<void, int> F2P;
+  const auto nranks = ttg::default_execution_context().size();
+
+  auto fib_op = ttg::make_tt(
+      [fib_fn = std::forward<FibFn>(fib_fn)](const int &n, const std::pair<int, int> &F_np1_n,
+                                             std::tuple<ttg::Out<int, std::pair<int, int>>, ttg::Out<void, int>> &outs) {
+        fib_fn(n, [&]() {
+          const auto &[F_n_plus_1, F_n] = F_np1_n;
+          if (F_n_plus_1 < N) {
+            const auto F_n_plus_2 = F_n_plus_1 + F_n;
+            ttg::sendv<1>(F_n_plus_1, outs);
+            ttg::send<0>(n + 1, std::make_pair(F_n_plus_2, F_n_plus_1), outs);
+          } else {
+            ttg::set_size<1>(n, outs);
+          }
+        });
+      },
+      ttg::edges(F2F), ttg::edges(F2F, F2P));
+  auto result_op = ttg::make_tt(
+      [result_fn = std::forward<ResultFn>(result_fn)](const int &value, std::tuple<> &out) { result_fn(value); },
+      ttg::edges(F2P), ttg::edges());
+  fib_op->set_keymap([=](const auto &key) { return nranks - 1; });
+  result_op->set_input_reducer<0>([](int &a, const int &b) { a = a + b; });
+  return std::make_pair(std::move(fib_op), std::move(result_op));
+}
+
 TEST_CASE("Fibonacci", "[fib][core]") {
-  // compute the reference result
+  // compute the reference result and the number of fib tasks computing it
   int reference_result = 0;
+  int reference_num_tasks = 0;
   {
     // recursive lambda pattern from http://pedromelendez.com/blog/2015/07/16/recursive-lambdas-in-c14/
-    auto compute_reference_result = [&reference_result](int f_np1, int f_n) {
-      auto impl = [&reference_result](int f_np1, int f_n, const auto &impl_ref) -> void {
+    auto compute_reference_result = [&reference_result, &reference_num_tasks](int f_np1, int f_n) {
+      auto impl = [&reference_result, &reference_num_tasks](int f_np1, int f_n, const auto &impl_ref) -> void {
         assert(f_n < N);
         reference_result += f_n;
+        ++reference_num_tasks;
         if (f_np1 < N) {
           const auto f_np2 = f_np1 + f_n;
           impl_ref(f_np2, f_np1, impl_ref);
@@ -69,43 +106,157 @@ TEST_CASE("Fibonacci", "[fib][core]") {
 
   // in distributed memory we must count how many messages the reducer will receive
   SECTION("distributed-memory") {
-    ttg::Edge<int, std::pair<int, int>> F2F;
-    ttg::Edge<void, int> F2P;
-    const auto nranks = ttg::default_execution_context().size();
+    // all fib tasks run on the last rank, the fib task beyond N tells the reducer how many messages to expect
+    auto [fib_op, result_op] = make_fib_graph([](int n, auto &&body) { body(); },
+                                              [reference_result](int value) {
+                                                ttg::print("sum of Fibonacci numbers up to ", N, " = ", value);
+                                                CHECK(value == reference_result);
+                                              });
+    fib_op->set_trace_instance(true);
+    make_graph_executable(fib_op);
+    ttg::ttg_fence(ttg::default_execution_context());
+    if (ttg::default_execution_context().rank() == 0) fib_op->invoke(0, std::make_pair(1, 0));
+    ttg::ttg_fence(ttg::default_execution_context());
+  }
 
-    auto fib_op = ttg::make_tt(
-        // computes next value: F_{n+2} = F_{n+1} + F_{n}, seeded by F_1 = 1, F_0 = 0
-        [](const int &n, const std::pair<int, int> &F_np1_n,
-           std::tuple<ttg::Out<int, std::pair<int, int>>, ttg::Out<void, int>> &outs) {
-          const auto &[F_n_plus_1, F_n] = F_np1_n;
-          if (F_n_plus_1 < N) {
-            const auto F_n_plus_2 = F_n_plus_1 + F_n;
-            ttg::print("sent ", F_n_plus_1, " to fib reducer");
-            ttg::sendv<1>(F_n_plus_1, outs);
-            ttg::send<0>(n + 1, std::make_pair(F_n_plus_2, F_n_plus_1), outs);
-          } else {
-            // how many messages the reducer should expect to receive
-            ttg::set_size<1>(n, outs);
-            ttg::print("fib reducer will expect ", n, " messages");
-          }
+  // same as above, but overlap the completion with other work
+  SECTION("asynchronous-fence") {
+    const auto nranks = ttg::default_execution_context().size();
+    std::atomic<int> num_tasks = 0;
+    std::atomic<int> result = 0;
+    auto [fib_op, result_op] = make_fib_graph(
+        [&](int n, auto &&body) {
+          num_tasks++;
+          body();
         },
-        ttg::edges(F2F), ttg::edges(F2F, F2P));
-    auto print_op = ttg::make_tt(
-        [reference_result](const int &value, std::tuple<> &out) {
-          ttg::print("sum of Fibonacci numbers up to ", N, " = ", value);
-          CHECK(value == reference_result);
+        [&](int value) {
+          /* the future must not complete before the result is stored */
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+          result = value;
+        });
+    make_graph_executable(fib_op);
+    ttg::execute();
+    if (ttg::default_execution_context().rank() == 0) fib_op->invoke(0, std::make_pair(1, 0));
+    auto done = ttg::fence_async();
+    done.wait();
+    if (ttg::default_execution_context().rank() == 0) CHECK(result == reference_result);
+    if (ttg::default_execution_context().rank() == nranks - 1) CHECK(num_tasks == reference_num_tasks);
+    ttg::fence();
+  }
+
+  // same as above, but the (cheap) fib tasks are executed by their producers
+  SECTION("inline-execution") {
+    const auto nranks = ttg::default_execution_context().size();
+    /* fib task n+1 executes within the send of fib task n, i.e., on top of it */
+    static thread_local int depth = 0;
+    std::atomic<int> num_nested = 0;
+    auto [fib_op, result_op] = make_fib_graph(
+        [&](int n, auto &&body) {
+          if (depth > 0) num_nested++;
+          ++depth;
+          body();
+          --depth;
         },
-        ttg::edges(F2P), ttg::edges());
-    // move all fib tasks to last rank, all reductions will happen on 0 => for some reason no reductions occur!
-    fib_op->set_keymap([=](const auto &key) { return nranks - 1; });
-    fib_op->set_trace_instance(true);
-    print_op->set_input_reducer<0>([](int &a, const int &b) {
-      ttg::print("fib reducer: current value = ", a, ", incremented by ", b, " set to ", a + b);
-      a = a + b;
-    });
+        [&](int value) { CHECK(value == reference_result); });
+    CHECK(fib_op->set_execution(ttg::Execution::Inline) == ttg::Execution::Async);
+    CHECK(fib_op->get_execution() == ttg::Execution::Inline);
     make_graph_executable(fib_op);
     ttg::ttg_fence(ttg::default_execution_context());
     if (ttg::default_execution_context().rank() == 0) fib_op->invoke(0, std::make_pair(1, 0));
     ttg::ttg_fence(ttg::default_execution_context());
+    if (ttg::default_execution_context().rank() == nranks - 1) CHECK(num_nested > 0);
+  }
+
+  // tasks of an inline TT are executed by the tasks of another TT that make them ready
+  SECTION("inline-execution-across-tts") {
+    constexpr int num_keys = 16;
+    static thread_local bool in_producer = false;
+    std::atomic<int> num_nested = 0;
+    std::atomic<int> num_consumed = 0;
+    ttg::Edge<int, int> P2C;
+    auto producer = ttg::make_tt<int>(
+        [](const int &n, std::tuple<ttg::Out<int, int>> &outs) {
+          in_producer = true;
+          ttg::send<0>(n, n, outs);
+          in_producer = false;
+        },
+        ttg::edges(), ttg::edges(P2C));
+    auto consumer = ttg::make_tt(
+        [&](const int &n, const int &value, std::tuple<> &out) {
+          CHECK(value == n);
+          if (in_producer) num_nested++;
+          num_consumed++;
+        },
+        ttg::edges(P2C), ttg::edges());
+    producer->set_keymap([](const int &) { return 0; });
+    consumer->set_keymap([](const int &) { return 0; });
+    consumer->set_execution(ttg::Execution::Inline);
+    make_graph_executable(producer);
+    ttg::execute();
+    if (ttg::default_execution_context().rank() == 0) {
+      for (int n = 0; n < num_keys; ++n) producer->invoke(n);
+    }
+    ttg::fence();
+    if (ttg::default_execution_context().rank() == 0) {
+      CHECK(num_consumed == num_keys);
+      CHECK(num_nested > 0);
+    }
+  }
+
+#ifdef TTG_USE_PARSEC
+  // same as above, but fib tasks made ready by their producer bypass the scheduler and run on the same thread
+  SECTION("scheduler-bypass") {
+    const auto nranks = ttg::default_execution_context().size();
+    /* tasks bypassing the scheduler are executed nested in the execution of their producer */
+    std::atomic<int> num_bypassed = 0;
+    auto [fib_op, result_op] = make_fib_graph(
+        [&](int n, auto &&body) {
+          if (ttg_parsec::detail::inline_depth > 0) num_bypassed++;
+          body();
+        },
+        [&](int value) { CHECK(value == reference_result); });
+    CHECK(!fib_op->get_inlining());
+    make_graph_executable(fib_op);
+    /* first run without, then with scheduler bypass */
+    for (bool inlining : {false, true}) {
+      fib_op->set_inlining(inlining);
+      CHECK(fib_op->get_inlining() == inlining);
+      num_bypassed = 0;
+      ttg::execute();
+      if (ttg::default_execution_context().rank() == 0) fib_op->invoke(0, std::make_pair(1, 0));
+      ttg::fence();
+      if (ttg::default_execution_context().rank() == nranks - 1) {
+        if (inlining) {
+          CHECK(num_bypassed > 0);
+        } else {
+          CHECK(num_bypassed == 0);
+        }
+      }
+    }
+  }
+
+  // the same graph executed in several epochs, with and without reusing the taskpool across fences
+  SECTION("repeated-epochs") {
+    std::atomic<int> num_results = 0;
+    auto [fib_op, result_op] = make_fib_graph([](int n, auto &&body) { body(); },
+                                              [&](int value) {
+                                                CHECK(value == reference_result);
+                                                num_results++;
+                                              });
+    make_graph_executable(fib_op);
+
+    auto reuse_taskpool_save = ttg_parsec::detail::reuse_taskpool;
+    constexpr int num_epochs = 3;
+    for (bool reuse_taskpool : {false, true}) {
+      ttg_parsec::detail::reuse_taskpool = reuse_taskpool;
+      for (int epoch = 0; epoch < num_epochs; ++epoch) {
+        ttg::execute();
+        if (ttg::default_execution_context().rank() == 0) fib_op->invoke(0, std::make_pair(1, 0));
+        ttg::fence();
+      }
+    }
+    ttg_parsec::detail::reuse_taskpool = reuse_taskpool_save;
+    if (ttg::default_execution_context().rank() == 0) CHECK(num_results == 2 * num_epochs);
   }
+#endif  // TTG_USE_PARSEC
 }  // TEST_CAST("Fibonacci")
@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <numeric>
+#include <vector>
 
 #include "ttg.h"
 
@@ -120,6 +123,42 @@ namespace ttg {
 } // namespace ttg
 
 
+/* a tile whose descriptor creates received tiles from the recycling pool of its type */
+struct PooledTile : public MatrixTile<double> {
+  using MatrixTile<double>::MatrixTile;
+};
+
+/* number of tiles created from the recycling pool */
+inline std::atomic<int> num_recycled_tiles = 0;
+
+namespace ttg {
+
+  template<>
+  struct SplitMetadataDescriptor<PooledTile>
+  {
+
+    auto get_metadata(const PooledTile& t)
+    {
+      return t.get_metadata();
+    }
+
+    auto get_data(PooledTile& t)
+    {
+      return std::array<iovec, 1>({t.size()*sizeof(double), t.data()});
+    }
+
+    auto create_from_metadata(const PooledTile::metadata_t& meta, ttg::RecyclingPool<PooledTile, PooledTile::metadata_t>& pool)
+    {
+      if (auto obj = pool.acquire(meta)) {
+        ++num_recycled_tiles;
+        return std::move(*obj);
+      }
+      return PooledTile(meta);
+    }
+  };
+
+} // namespace ttg
+
 template <typename T>
 auto make_producer(ttg::Edge<int, MatrixTile<T>>& out1, ttg::Edge<int, MatrixTile<T>>& out2)
 {
@@ -215,3 +254,145 @@ TEST_CASE("Split-Metadata Serialization", "[serialization]") {
   return 0;
 }
 
+
+TEST_CASE("Recycling Pool", "[serialization]") {
+  static_assert(!ttg::has_recycling_pool<MatrixTile<int>>::value);
+
+  ttg::RecyclingPool<MatrixTile<double>, MatrixTile<double>::metadata_t> pool;
+  CHECK(!pool.acquire({N, M}));
+
+  MatrixTile<double> tile{N, M};
+  const double *data = tile.data();
+  pool.release(tile.get_metadata(), std::move(tile));
+  CHECK(!pool.acquire({M, N + 1}));
+  auto recycled = pool.acquire({N, M});
+  REQUIRE(recycled);
+  CHECK(recycled->data() == data);
+  CHECK(!pool.acquire({N, M}));
+
+  pool.set_capacity(1);
+  pool.release({N, M}, MatrixTile<double>{N, M});
+  pool.release({N, M}, MatrixTile<double>{N, M});
+  CHECK(pool.acquire({N, M}));
+  CHECK(!pool.acquire({N, M}));
+
+  /* the pool holds at most max_bytes() and accounts them in the live data */
+  pool.set_capacity(8);
+  pool.set_max_bytes(2 * sizeof(MatrixTile<double>));
+  auto live_bytes = ttg::live_data_bytes();
+  pool.release({N, M}, MatrixTile<double>{N, M});
+  pool.release({N, M}, MatrixTile<double>{N, M});
+  pool.release({N, M}, MatrixTile<double>{N, M});
+  CHECK(pool.bytes() == 2 * sizeof(MatrixTile<double>));
+  CHECK(ttg::live_data_bytes() == live_bytes + pool.bytes());
+  pool.clear();
+  CHECK(pool.bytes() == 0);
+  CHECK(ttg::live_data_bytes() == live_bytes);
+
+#ifdef TTG_USE_PARSEC
+  /* received tiles are released into the pool of their type once consumed, and reused by later transfers */
+  {
+    static_assert(ttg::has_recycling_pool<PooledTile>::value);
+    auto world = ttg::default_execution_context();
+    ttg::Edge<int, PooledTile> edge("POOLED TILES");
+    constexpr int num_tiles = 8;
+
+    auto producer = ttg::make_tt<int>(
+        [](const int &key, std::tuple<ttg::Out<int, PooledTile>> &out) {
+          PooledTile tile{N, M};
+          std::fill(tile.data(), tile.data() + tile.size(), key);
+          ttg::send<0>(key, std::move(tile), out);
+        },
+        ttg::edges(), ttg::edges(edge), "POOLED PRODUCER");
+    auto consumer = ttg::make_tt(
+        [](const int &key, const PooledTile &tile, std::tuple<> &out) {
+          for (std::size_t i = 0; i < tile.size(); ++i) {
+            CHECK(tile.data()[i] == key);
+          }
+        },
+        ttg::edges(edge), ttg::edges(), "POOLED CONSUMER");
+    producer->set_keymap([](const int &) { return 0; });
+    consumer->set_keymap([&](const int &) { return world.size() - 1; });
+
+    auto connected = make_graph_executable(producer.get());
+    CHECK(connected);
+    /* tiles received in the first epoch are recycled in the second */
+    for (int epoch = 0; epoch < 2; ++epoch) {
+      ttg::execute(world);
+      if (world.rank() == 0) {
+        for (int key = 0; key < num_tiles; ++key) producer->invoke(key);
+      }
+      ttg::fence(world);
+    }
+    if (world.size() > 1 && world.rank() == world.size() - 1) {
+      CHECK(num_recycled_tiles > 0);
+    }
+    CHECK(ttg::recycling_pool<PooledTile>().bytes() <= ttg::recycling_pool<PooledTile>().max_bytes());
+  }
+#endif  // TTG_USE_PARSEC
+
+#ifdef TTG_USE_MADNESS
+  /* tiles sent to and broadcast on other processes carry their payload next to their metadata,
+   * received tiles are created from the pool of their type */
+  {
+    auto world = ttg::default_execution_context();
+    ttg::Edge<int, PooledTile> sent("SENT TILES"), broadcast("BROADCAST TILES");
+    constexpr int num_tiles = 8;
+    std::atomic<int> num_received = 0;
+
+    auto producer = ttg::make_tt<int>(
+        [](const int &key, std::tuple<ttg::Out<int, PooledTile>, ttg::Out<int, PooledTile>> &out) {
+          auto world = ttg::default_execution_context();
+          PooledTile tile{N, M};
+          std::fill(tile.data(), tile.data() + tile.size(), key);
+          /* one copy per process */
+          std::vector<int> keys(world.size());
+          std::iota(keys.begin(), keys.end(), key * world.size());
+          ttg::broadcast<1>(keys, tile, out);
+          ttg::send<0>(key, std::move(tile), out);
+        },
+        ttg::edges(), ttg::edges(sent, broadcast), "SPLITMD PRODUCER");
+    auto consumer = ttg::make_tt(
+        [&](const int &key, const PooledTile &tile, std::tuple<> &out) {
+          for (std::size_t i = 0; i < tile.size(); ++i) {
+            CHECK(tile.data()[i] == key);
+          }
+          ++num_received;
+        },
+        ttg::edges(sent), ttg::edges(), "SPLITMD CONSUMER");
+    auto broadcast_consumer = ttg::make_tt(
+        [&](const int &key, const PooledTile &tile, std::tuple<> &out) {
+          auto world = ttg::default_execution_context();
+          for (std::size_t i = 0; i < tile.size(); ++i) {
+            CHECK(tile.data()[i] == key / world.size());
+          }
+          ++num_received;
+        },
+        ttg::edges(broadcast), ttg::edges(), "SPLITMD BROADCAST CONSUMER");
+    producer->set_keymap([](const int &) { return 0; });
+    consumer->set_keymap([&](const int &) { return world.size() - 1; });
+    broadcast_consumer->set_keymap([&](const int &key) { return key % world.size(); });
+
+    /* give the receiving process tiles to recycle */
+    num_recycled_tiles = 0;
+    if (world.rank() == world.size() - 1) {
+      for (int i = 0; i < 2; ++i) ttg::recycling_pool<PooledTile>().release({N, M}, PooledTile{N, M});
+    }
+
+    auto connected = make_graph_executable(producer.get());
+    CHECK(connected);
+    ttg::execute(world);
+    if (world.rank() == 0) {
+      for (int key = 0; key < num_tiles; ++key) producer->invoke(key);
+    }
+    ttg::fence(world);
+
+    /* every process receives one broadcast tile per producer, the last also receives the sent tiles */
+    CHECK(num_received == num_tiles + (world.rank() == world.size() - 1 ? num_tiles : 0));
+    if (world.size() > 1 && world.rank() == world.size() - 1) {
+      CHECK(num_recycled_tiles > 0);
+    }
+    ttg::recycling_pool<PooledTile>().clear();
+  }
+#endif  // TTG_USE_MADNESS
+}
@@ -1,9 +1,13 @@
 #include <catch2/catch_all.hpp>
 #include <ctime>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #include "ttg.h"
 
 #include "ttg/serialization/std/pair.h"
+#include "ttg/serialization/std/vector.h"
 #include "ttg/util/hash/std/pair.h"
 
 
@@ -207,4 +211,210 @@ TEST_CASE("streams", "[streams][core]") {
     ttg::ttg_fence(ttg::default_execution_context());
     CHECK(reduce_ops == N/nranks);
   }
+
+#ifdef TTG_USE_PARSEC
+  SECTION("tree-and-ordered-reductions") {
+    ttg::Edge<int, int> I2O;
+    ttg::Edge<int, int> O2S;
+
+    constexpr int N = 4000;
+    constexpr int SLICE = 400;
+    std::atomic<int> num_sinks = 0;
+
+    auto op = ttg::make_tt(
+        [&](const int &n, const int &i, std::tuple<ttg::Out<int, int>> &outs) {
+          ttg::send<0>(n % 4, int{i}, outs);
+        },
+        ttg::edges(I2O), ttg::edges(O2S));
+
+    auto sink_op = ttg::make_tt(
+        [&](const int key, const int &value) {
+          int expected = 0;
+          for (int n = key; n < N; n += 4) expected += n;
+          CHECK(value == expected);
+          num_sinks++;
+        },
+        ttg::edges(O2S), ttg::edges());
+
+    sink_op->set_input_reducer<0>([](int &a, const int &b) { a += b; }, N / 4);
+    sink_op->set_keymap([](const int &key) { return key % 2 == 0 ? 0 : ttg::default_execution_context().size() - 1; });
+    /* first epoch: tree reductions */
+    sink_op->set_input_tree_reduction<0>();
+    make_graph_executable(op);
+    ttg::execute(ttg::default_execution_context());
+    if (ttg::default_execution_context().rank() == 0) {
+      for (int i = 0; i < N; ++i) {
+        op->invoke(i, i);
+      }
+    }
+    ttg::ttg_fence(ttg::default_execution_context());
+
+    /* second epoch: ordered reductions */
+    sink_op->set_input_reduction_order<0>([](const int &a, const int &b) { return a < b; });
+    ttg::execute(ttg::default_execution_context());
+    if (ttg::default_execution_context().rank() == 0) {
+      for (int i = 0; i < N; ++i) {
+        op->invoke(i, i);
+      }
+    }
+    ttg::ttg_fence(ttg::default_execution_context());
+    if (ttg::default_execution_context().size() == 1) CHECK(num_sinks == 8);
+  }
+
+  // the result of ordered reductions does not depend on the order in which contributions arrive
+  SECTION("ordered-reduction-determinism") {
+    ttg::Edge<int, int> I2O;
+    ttg::Edge<int, std::vector<int>> O2C;
+    ttg::Edge<int, double> O2F;
+
+    constexpr int N = 400;
+    constexpr int K = 4;
+    std::mutex mtx;
+    std::map<int, std::vector<int>> concatenations;
+    std::map<int, double> sums;
+
+    auto op = ttg::make_tt(
+        [&](const int &n, const int &i, std::tuple<ttg::Out<int, std::vector<int>>, ttg::Out<int, double>> &outs) {
+          ttg::send<0>(n % K, std::vector<int>{n}, outs);
+          /* floating-point additions of values of different magnitudes are not associative */
+          ttg::send<1>(n % K, (n % 3 == 0 ? 1e16 : 1.0) / (n + 1), outs);
+        },
+        ttg::edges(I2O), ttg::edges(O2C, O2F));
+
+    auto sink_op = ttg::make_tt(
+        [&](const int key, const std::vector<int> &concatenation, const double &sum) {
+          std::lock_guard<std::mutex> lock(mtx);
+          concatenations[key] = concatenation;
+          sums[key] = sum;
+        },
+        ttg::edges(O2C, O2F), ttg::edges());
+
+    op->set_keymap([](const int &n) { return n % ttg::default_execution_context().size(); });
+    sink_op->set_keymap([](const int &key) { return 0; });
+    sink_op->set_input_reducer<0>([](std::vector<int> &a, const std::vector<int> &b) { a.insert(a.end(), b.begin(), b.end()); },
+                                  N / K);
+    sink_op->set_input_reducer<1>([](double &a, const double &b) { a += b; }, N / K);
+    /* the contributions are ordered by the contributing task */
+    sink_op->set_input_reduction_order<0>([](const std::vector<int> &a, const std::vector<int> &b) { return a[0] < b[0]; });
+    sink_op->set_input_reduction_order<1>([](const double &a, const double &b) { return a < b; });
+    make_graph_executable(op);
+
+    std::map<int, double> first_sums;
+    for (int run = 0; run < 2; ++run) {
+      ttg::execute(ttg::default_execution_context());
+      if (ttg::default_execution_context().rank() == 0) {
+        /* contributions arrive in a different order in each run */
+        for (int k = 0; k < N; ++k) {
+          int n = (run == 0) ? k : N - 1 - k;
+          op->invoke(n, n);
+        }
+      }
+      ttg::ttg_fence(ttg::default_execution_context());
+      if (ttg::default_execution_context().rank() == 0) {
+        for (int key = 0; key < K; ++key) {
+          /* concatenation is associative but not commutative, so the result is the sorted sequence */
+          std::vector<int> expected;
+          for (int n = key; n < N; n += K) expected.push_back(n);
+          CHECK(concatenations[key] == expected);
+        }
+        if (run == 0) {
+          first_sums = sums;
+        } else {
+          CHECK(sums == first_sums);
+        }
+      }
+    }
+  }
+
+  // contributions coalesced by the sender must not be overtaken by the stream size or finalize messages
+  SECTION("aggregated-contributions-and-stream-control") {
+    ttg::Edge<int, int> I2O;
+    ttg::Edge<int, int> O2S;
+    const auto nranks = ttg::default_execution_context().size();
+
+    constexpr int M = 100;
+    std::atomic<int> num_sinks = 0;
+
+    auto op = ttg::make_tt(
+        [&](const int &n, const int &i, std::tuple<ttg::Out<int, int>> &outs) {
+          /* key 2n is sized, key 2n+1 is finalized, all contributions are sent from the same task */
+          ttg::set_size<0>(2 * n, M, outs);
+          for (int m = 0; m < M; ++m) {
+            ttg::send<0>(2 * n, int{1}, outs);
+            ttg::send<0>(2 * n + 1, int{1}, outs);
+          }
+          ttg::finalize<0>(2 * n + 1, outs);
+        },
+        ttg::edges(I2O), ttg::edges(O2S));
+
+    auto sink_op = ttg::make_tt(
+        [&](const int key, const int &value) {
+          CHECK(value == M);
+          num_sinks++;
+        },
+        ttg::edges(O2S), ttg::edges());
+
+    op->set_keymap([](const int &) { return 0; });
+    sink_op->set_keymap([=](const int &key) { return nranks - 1; });
+    sink_op->set_input_reducer<0>([](int &a, const int &b) { a += b; });
+    sink_op->set_aggregation<0>(true);
+
+    make_graph_executable(op);
+    ttg::execute(ttg::default_execution_context());
+    if (ttg::default_execution_context().rank() == 0) {
+      for (int n = 0; n < 8; ++n) {
+        op->invoke(n, n);
+      }
+    }
+    ttg::ttg_fence(ttg::default_execution_context());
+    if (ttg::default_execution_context().rank() == nranks - 1) CHECK(num_sinks == 16);
+  }
+
+  // large contributions must not be overtaken by the finalize message, even if large messages are unpacked by workers
+  SECTION("large-contributions-and-finalize") {
+    ttg::Edge<int, int> I2O;
+    ttg::Edge<int, std::vector<double>> O2S;
+    const auto nranks = ttg::default_execution_context().size();
+
+    constexpr int M = 20;
+    constexpr std::size_t LEN = 4096;
+    std::atomic<int> num_sinks = 0;
+    auto offload_size_save = ttg_parsec::detail::unpack_offload_size;
+    ttg_parsec::detail::unpack_offload_size = 1024;
+
+    auto op = ttg::make_tt(
+        [&](const int &n, const int &i, std::tuple<ttg::Out<int, std::vector<double>>> &outs) {
+          for (int m = 0; m < M; ++m) {
+            ttg::send<0>(n, std::vector<double>(LEN, 1.0), outs);
+          }
+          ttg::finalize<0>(n, outs);
+        },
+        ttg::edges(I2O), ttg::edges(O2S));
+
+    auto sink_op = ttg::make_tt(
+        [&](const int key, const std::vector<double> &value) {
+          CHECK(value.size() == LEN);
+          CHECK(value[0] == M);
+          num_sinks++;
+        },
+        ttg::edges(O2S), ttg::edges());
+
+    op->set_keymap([](const int &) { return 0; });
+    sink_op->set_keymap([=](const int &key) { return nranks - 1; });
+    sink_op->set_input_reducer<0>([](std::vector<double> &a, const std::vector<double> &b) {
+      for (std::size_t k = 0; k < a.size(); ++k) a[k] += b[k];
+    });
+
+    make_graph_executable(op);
+    ttg::execute(ttg::default_execution_context());
+    if (ttg::default_execution_context().rank() == 0) {
+      for (int n = 0; n < 8; ++n) {
+        op->invoke(n, n);
+      }
+    }
+    ttg::ttg_fence(ttg::default_execution_context());
+    ttg_parsec::detail::unpack_offload_size = offload_size_save;
+    if (ttg::default_execution_context().rank() == nranks - 1) CHECK(num_sinks == 8);
+  }
+#endif // TTG_USE_PARSEC
 }  // TEST_CASE("streams")
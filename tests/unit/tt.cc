@@ -3,8 +3,10 @@
 #include "ttg.h"
 
 #include <memory>
+#include <numeric>
 
 #include "ttg/util/meta/callable.h"
+#include "ttg/util/multiindex.h"
 
 // {task_id,data} = {void, void}
 namespace tt_v_v {
@@ -442,4 +444,102 @@ TEST_CASE("TemplateTask", "[core]") {
       static_assert(!ttg::meta::is_generic_callable_v<decltype(&args_pmf::X::g<int>)>);
     }
   }
+
+#ifdef TTG_USE_PARSEC
+  // keys of other processes are forwarded by the receivers of a tree-based broadcast
+  SECTION("tree-broadcast") {
+    ttg::Edge<int, int> I2B;
+    ttg::Edge<int, std::vector<int>> B2S;
+    auto world = ttg::default_execution_context();
+    const auto nranks = world.size();
+    constexpr int K = 64;
+    std::atomic<int> num_received = 0;
+
+    auto bcast_op = ttg::make_tt(
+        [&](const int &n, const int &i, std::tuple<ttg::Out<int, std::vector<int>>> &outs) {
+          std::vector<int> keys(K);
+          std::iota(keys.begin(), keys.end(), 0);
+          ttg::broadcast<0>(keys, std::vector<int>(K, i), outs);
+        },
+        ttg::edges(I2B), ttg::edges(B2S));
+
+    auto sink_op = ttg::make_tt(
+        [&](const int &key, const std::vector<int> &value) {
+          CHECK(value.size() == K);
+          CHECK(value[key] == 42);
+          num_received++;
+        },
+        ttg::edges(B2S), ttg::edges());
+
+    bcast_op->set_keymap([](const int &) { return 0; });
+    sink_op->set_keymap([=](const int &key) { return key % nranks; });
+    sink_op->set_broadcast_radix<0>(2);
+
+    make_graph_executable(bcast_op);
+    ttg::execute(world);
+    if (world.rank() == 0) bcast_op->invoke(0, 42);
+    ttg::ttg_fence(world);
+    int expected = 0;
+    for (int key = 0; key < K; ++key) {
+      if (key % nranks == world.rank()) ++expected;
+    }
+    CHECK(num_received == expected);
+  }
+
+  // keys outside of the dense task table are kept in the hash table
+  SECTION("dense-task-table") {
+    using UKey = ttg::MultiIndex<2, unsigned>;
+    ttg::Edge<UKey, int> U0, U1;
+    ttg::Edge<int, int> I0, I1;
+    auto world = ttg::default_execution_context();
+    constexpr int K = 6;
+    std::atomic<int> num_ukeys = 0;
+    std::atomic<int> num_ikeys = 0;
+
+    auto producer_op = ttg::make_tt(
+        [&](std::tuple<ttg::Out<UKey, int>, ttg::Out<UKey, int>, ttg::Out<int, int>, ttg::Out<int, int>> &outs) {
+          for (unsigned i = 0; i < K; ++i) {
+            for (unsigned j = 0; j < K; ++j) {
+              ttg::send<0>(UKey{i, j}, int(i), outs);
+              ttg::send<1>(UKey{i, j}, int(j), outs);
+            }
+          }
+          for (int i = -K; i < 2 * K; ++i) {
+            ttg::send<2>(i, int{i}, outs);
+            ttg::send<3>(i, int{i}, outs);
+          }
+        },
+        ttg::edges(), ttg::edges(U0, U1, I0, I1));
+    auto ukey_op = ttg::make_tt(
+        [&](const UKey &key, const int &i, const int &j) {
+          CHECK(key[0] == i);
+          CHECK(key[1] == j);
+          num_ukeys++;
+        },
+        ttg::edges(U0, U1), ttg::edges());
+    auto ikey_op = ttg::make_tt(
+        [&](const int &key, const int &a, const int &b) {
+          CHECK(key == a);
+          CHECK(key == b);
+          num_ikeys++;
+        },
+        ttg::edges(I0, I1), ttg::edges());
+
+    producer_op->set_keymap([]() { return 0; });
+    ukey_op->set_keymap([](const UKey &) { return 0; });
+    ikey_op->set_keymap([](const int &) { return 0; });
+    /* only part of the keys fall into the tables, the others use the npos fallback */
+    ukey_op->set_dense_task_table(UKey{K / 2, K / 2});
+    ikey_op->set_dense_task_table(0, K);
+
+    make_graph_executable(producer_op);
+    ttg::execute(world);
+    if (world.rank() == 0) producer_op->invoke();
+    ttg::ttg_fence(world);
+    if (world.rank() == 0) {
+      CHECK(num_ukeys == K * K);
+      CHECK(num_ikeys == 3 * K);
+    }
+  }
+#endif  // TTG_USE_PARSEC
 }
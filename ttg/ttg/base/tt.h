@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "ttg/base/terminal.h"
+#include "ttg/execution.h"
 #include "ttg/util/demangle.h"
 #include "ttg/util/trace.h"
 
@@ -43,6 +44,7 @@ namespace ttg {
     bool executable = false;  //!< ready to execute?
     bool is_ttg_ = false;
     bool lazy_pull_instance = false;
+    ttg::Execution execution = ttg::Execution::Async;  //!< execution policy of the tasks of this TT
 
     // Default copy/move/assign all OK
     static uint64_t next_instance_id() {
@@ -199,6 +201,20 @@ namespace ttg {
 
     bool is_lazy_pull() { return ttg::detail::op_base_lazy_pull_accessor() || lazy_pull_instance; }
 
+    /// Sets the execution policy of the tasks of this TT and returns the previous setting.
+    /// With ttg::Execution::Inline a task whose inputs are complete is executed synchronously by the
+    /// task that provided its last input, skipping the task queue, as long as the nesting depth of
+    /// inlined tasks stays below the backend's limit; otherwise it is enqueued.
+    /// ttg::Execution::Async (the default) always enqueues ready tasks.
+    /// Inline execution is meant for cheap tasks; long-running tasks delay their producers.
+    ttg::Execution set_execution(ttg::Execution value) {
+      std::swap(execution, value);
+      return value;
+    }
+
+    /// @return the execution policy of the tasks of this TT
+    ttg::Execution get_execution() const { return execution; }
+
     std::optional<std::reference_wrapper<const TTBase>> ttg() const {
       return owning_ttg ? std::cref(*owning_ttg) : std::optional<std::reference_wrapper<const TTBase>>{};
     }
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <set>
 
 #include "ttg/base/tt.h"
@@ -40,6 +41,7 @@ namespace ttg {
       std::list<ttg::TTBase*> m_op_register;
       std::vector<std::shared_ptr<std::promise<void>>> m_statuses;
       std::vector<std::function<void()>> m_callbacks;
+      std::mutex m_status_mtx;  //< protects m_statuses and m_callbacks, which may be triggered by a runtime thread
       std::vector<std::shared_ptr<void>> m_ptrs;
       std::vector<std::unique_ptr<void, std::function<void(void*)>>> m_unique_ptrs;
       int world_size;
@@ -51,6 +53,32 @@ namespace ttg {
 
       virtual void fence_impl(void) = 0;
 
+      /**
+       * Starts the completion of the current epoch without waiting for it, see fence_async().
+       * Implementations call trigger_statuses() once all tasks have completed.
+       * By default, this waits for the completion.
+       */
+      virtual void fence_async_impl(void) {
+        fence_impl();
+        trigger_statuses();
+      }
+
+      /* fulfills the registered statuses and invokes the registered callbacks */
+      void trigger_statuses(void) {
+        std::unique_lock<std::mutex> lock(m_status_mtx);
+        auto statuses = std::move(m_statuses);
+        auto callbacks = std::move(m_callbacks);
+        m_statuses.clear();
+        m_callbacks.clear();
+        lock.unlock();
+        for (auto& status : statuses) {
+          status->set_value();
+        }
+        for (auto&& callback : callbacks) {
+          callback();
+        }
+      }
+
       void release_ops(void) {
         while (!m_op_register.empty()) {
           (*m_op_register.begin())->release();
@@ -92,11 +120,13 @@ namespace ttg {
       }
 
       void register_status(const std::shared_ptr<std::promise<void>>& status_ptr) {
+        std::lock_guard<std::mutex> lock(m_status_mtx);
         m_statuses.emplace_back(status_ptr);
       }
 
       template <typename Callback>
       void register_callback(Callback&& callback) {
+        std::lock_guard<std::mutex> lock(m_status_mtx);
         m_callbacks.emplace_back(callback);
       }
 
@@ -108,14 +138,23 @@ namespace ttg {
        */
       void fence(void) {
         fence_impl();
-        for (auto& status : m_statuses) {
-          status->set_value();
-        }
-        m_statuses.clear();  // clear out the statuses
-        for (auto&& callback : m_callbacks) {
-          callback();
-        }
-        m_callbacks.clear();  // clear out the statuses
+        trigger_statuses();
+      }
+
+      /**
+       * Signal that no more tasks will be submitted to this world by the calling process
+       * and return without waiting for the tasks to complete. The returned future becomes
+       * ready (and registered statuses and callbacks are triggered) once all tasks in this
+       * world have completed execution on all processes. This is a collective call.
+       * fence() has to be called before new tasks are submitted; it returns as soon as
+       * the pending tasks have completed.
+       */
+      std::future<void> fence_async(void) {
+        auto status = std::make_shared<std::promise<void>>();
+        auto future = status->get_future();
+        register_status(status);
+        fence_async_impl();
+        return future;
       }
 
       /**
@@ -1,12 +1,23 @@
 #ifndef TTG_CONSTRAINT_H
 #define TTG_CONSTRAINT_H
 
+#include <algorithm>
 #include <functional>
+#include <array>
 #include <atomic>
+#include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <map>
+#include <thread>
+#include <deque>
+#include <limits>
+#include <utility>
+#include <vector>
 
+#include "ttg/util/footprint.h"
 #include "ttg/util/span.h"
 
 #ifdef TTG_USE_BUNDLED_BOOST_CALLABLE_TRAITS
@@ -80,6 +91,8 @@ namespace ttg {
   protected:
     struct sequence_elem_t {
       std::map<ttg::TTBase*, std::vector<key_type>> m_keys;
+      std::size_t m_num_keys = 0;
+      double m_defer_time_sum = 0.0; //< sum of the times (relative to the constraint's epoch) at which keys were deferred
 
       sequence_elem_t() = default;
       sequence_elem_t(sequence_elem_t&&) = default;
@@ -87,16 +100,75 @@ namespace ttg {
       sequence_elem_t& operator=(sequence_elem_t&&) = default;
       sequence_elem_t& operator=(const sequence_elem_t&) = default;
 
-      void add_key(const key_type& key, ttg::TTBase* tt) {
+      void add_key(const key_type& key, ttg::TTBase* tt, double now) {
         auto it = m_keys.find(tt);
         if (it == m_keys.end()) {
           m_keys.insert(std::make_pair(tt, std::vector<key_type>{key}));
         } else {
           it->second.push_back(key);
         }
+        ++m_num_keys;
+        m_defer_time_sum += now;
       }
     };
 
+    /* Deferred keys are distributed over shards by the deferring thread, so threads deferring keys
+     * concurrently rarely contend. Keys are released with all shards locked, which happens once per ordinal. */
+    struct alignas(64) shard_t {
+      std::mutex m_mtx;
+      std::map<ordinal_type, sequence_elem_t, compare_t> m_sequence;
+    };
+
+    static constexpr std::size_t num_shards = 16;
+
+    /* keys released at once, grouped by TT */
+    using release_t = std::map<ttg::TTBase*, std::vector<key_type>>;
+
+    shard_t& local_shard() {
+      static thread_local const std::size_t idx = std::hash<std::thread::id>{}(std::this_thread::get_id()) % num_shards;
+      return m_shards[idx];
+    }
+
+    auto lock_shards() {
+      std::array<std::unique_lock<std::mutex>, num_shards> locks;
+      for (std::size_t i = 0; i < num_shards; ++i) {
+        locks[i] = std::unique_lock{m_shards[i].m_mtx};
+      }
+      return locks;
+    }
+
+    /* seconds since the constraint was created */
+    double now() const {
+      return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_epoch).count();
+    }
+
+    /* move the keys of elem into keys, accounting for the time they were deferred */
+    void extract(sequence_elem_t& elem, release_t& keys, double now) {
+      for (auto& [tt, ttkeys] : elem.m_keys) {
+        auto& target = keys[tt];
+        if (target.empty()) {
+          target = std::move(ttkeys);
+        } else {
+          target.insert(target.end(), std::make_move_iterator(ttkeys.begin()), std::make_move_iterator(ttkeys.end()));
+        }
+      }
+      m_num_deferred.fetch_sub(elem.m_num_keys, std::memory_order_relaxed);
+      m_num_released.fetch_add(elem.m_num_keys, std::memory_order_relaxed);
+      m_blocked_time += elem.m_num_keys * now - elem.m_defer_time_sum;
+    }
+
+    /* the lowest deferred ordinal, must be called with all shards locked */
+    const ordinal_type* first_ordinal() const {
+      const ordinal_type* first = nullptr;
+      for (std::size_t i = 0; i < num_shards; ++i) {
+        auto& seq = m_shards[i].m_sequence;
+        if (!seq.empty() && (first == nullptr || m_order(seq.begin()->first, *first))) {
+          first = &seq.begin()->first;
+        }
+      }
+      return first;
+    }
+
     bool comp_equal(const Ordinal& a, const Ordinal& b) const {
       return (!m_order(a, b) && !m_order(b, a));
     }
@@ -115,7 +187,8 @@ namespace ttg {
             m_current = ord;
           }
           return true;
-        } else if (m_sequence.empty() && m_auto_release && 0 == m_active.load(std::memory_order_relaxed)) {
+        } else if (m_auto_release && 0 == m_num_deferred.load(std::memory_order_relaxed) &&
+                   0 == m_active.load(std::memory_order_relaxed)) {
           // there are no keys (active or blocked) so we execute to avoid a deadlock
           // we don't change the current ordinal because there may be lower ordinals coming in later
           // NOTE: there is a race condition between the check here and the increment above.
@@ -126,56 +199,82 @@ namespace ttg {
         }
       }
       // key should be deferred
-      auto g = this->lock_guard();
-      if (!m_stopped && eligible(ord)) {
-        // someone released this ordinal while we took the lock
+      auto& shard = local_shard();
+      std::lock_guard g{shard.m_mtx};
+      /* Publish the deferral before rechecking: completing tasks look for deferred keys without
+       * the locks, so a task completing concurrently either sees the deferral and waits for our
+       * shard or has released its slot before we check m_active below. */
+      m_num_deferred.fetch_add(1, std::memory_order_seq_cst);
+      if (!m_stopped && (eligible(ord) ||
+                         (m_auto_release && 0 == m_active.load(std::memory_order_seq_cst)))) {
+        // someone released this ordinal or the last active task completed while we took the lock
+        m_num_deferred.fetch_sub(1, std::memory_order_relaxed);
+        if (m_auto_release) {
+          m_active.fetch_add(1, std::memory_order_relaxed);
+        }
         return true;
       }
-      auto it = m_sequence.find(ord);
-      if (it == m_sequence.end()) {
-        auto [iter, success] = m_sequence.insert(std::make_pair(ord, sequence_elem_t{}));
+      auto it = shard.m_sequence.find(ord);
+      if (it == shard.m_sequence.end()) {
+        auto [iter, success] = shard.m_sequence.insert(std::make_pair(ord, sequence_elem_t{}));
         assert(success);
         it = iter;
       }
-      it->second.add_key(key, tt);
+      it->second.add_key(key, tt, now());
+      m_num_deferred_total.fetch_add(1, std::memory_order_relaxed);
       return false;
     }
 
 
     void complete_key_impl() {
       if (m_auto_release) {
-        auto active = m_active.fetch_sub(1, std::memory_order_relaxed) - 1;
+        auto active = m_active.fetch_sub(1, std::memory_order_seq_cst) - 1;
         if (0 == active) {
           release_next();
         }
       }
     }
 
+    void notify(release_t& keys) {
+      for (auto& [tt, ttkeys] : keys) {
+        this->notify_listener(ttg::span<key_type>(ttkeys.data(), ttkeys.size()), tt);
+      }
+    }
+
     // used in the auto case
     void release_next() {
       if (this->m_stopped) {
         // don't release tasks if we're stopped
         return;
       }
+      /* pairs with the publication of deferrals in check_key_impl */
+      if (0 == m_num_deferred.load(std::memory_order_seq_cst)) {
+        return; // nothing to be done
+      }
       // trigger the next sequence
-      sequence_elem_t elem;
+      release_t keys;
       {
-        // extract the next sequence
-        auto g = this->lock_guard();
-        auto it = this->m_sequence.begin(); // sequence is ordered by ordinal
-        if (it == this->m_sequence.end()) {
+        // extract the next sequence from all shards
+        auto locks = lock_shards();
+        auto first = first_ordinal();
+        if (first == nullptr) {
           return; // nothing to be done
         }
-        this->m_current = it->first;
-        elem = std::move(it->second);
-        this->m_sequence.erase(it);
-      }
-
-      for (auto& seq : elem.m_keys) {
-        // account for the newly active keys
-        this->m_active.fetch_add(seq.second.size(), std::memory_order_relaxed);
-        this->notify_listener(ttg::span<key_type>(seq.second.data(), seq.second.size()), seq.first);
+        this->m_current = *first;
+        double t = now();
+        for (std::size_t i = 0; i < num_shards; ++i) {
+          auto& seq = m_shards[i].m_sequence;
+          auto it = seq.find(this->m_current);
+          if (it == seq.end()) continue;
+          extract(it->second, keys, t);
+          seq.erase(it);
+        }
+        // account for the newly active keys before they can complete
+        for (auto& [tt, ttkeys] : keys) {
+          this->m_active.fetch_add(ttkeys.size(), std::memory_order_relaxed);
+        }
       }
+      notify(keys);
     }
 
 
@@ -189,26 +288,23 @@ namespace ttg {
       if (!force_check && eligible(ord)) {
         return; // already at the provided ordinal, nothing to be done
       }
-      // trigger the next sequence(s) (m_sequence is ordered by ordinal)
-      std::vector<sequence_elem_t> seqs;
+      // trigger the next sequence(s), released keys of all eligible ordinals are passed to each listener at once
+      release_t keys;
       {
-        auto g = this->lock_guard();
+        auto locks = lock_shards();
         // set current ordinal
         this->m_current = ord;
-        for (auto it = this->m_sequence.begin(); it != this->m_sequence.end();) {
-          if (!eligible(it->first)) break;
-          // extract the next sequence
-          this->m_current = it->first;
-          seqs.push_back(std::move(it->second));
-          it = this->m_sequence.erase(it);
-        }
-      }
-      for (auto& elem : seqs) {
-        for (auto& e : elem.m_keys) {
-          // account for the newly active keys
-          this->notify_listener(ttg::span<key_type>(e.second.data(), e.second.size()), e.first);
+        double t = now();
+        for (std::size_t i = 0; i < num_shards; ++i) {
+          auto& seq = m_shards[i].m_sequence; // ordered by ordinal
+          auto it = seq.begin();
+          for (; it != seq.end() && eligible(it->first); ++it) {
+            extract(it->second, keys, t);
+          }
+          seq.erase(seq.begin(), it);
         }
       }
+      notify(keys);
     }
 
   public:
@@ -313,9 +409,11 @@ namespace ttg {
         } else {
           auto ord = m_current;
           // release the first set of available keys if none were set explicitly
-          if (ord == std::numeric_limits<ordinal_type>::min() &&
-              this->m_sequence.begin() != this->m_sequence.end()) {
-            ord = this->m_sequence.begin()->first;
+          if (ord == std::numeric_limits<ordinal_type>::min()) {
+            auto locks = lock_shards();
+            if (auto first = first_ordinal()) {
+              ord = *first;
+            }
           }
           release_next(ord, true); // force the check for a next release even if the current ordinal hasn't changed
         }
@@ -339,15 +437,40 @@ namespace ttg {
       return m_auto_release;
     }
 
+    struct stats_t {
+      std::size_t deferred = 0;     //< number of keys deferred since the constraint was created
+      std::size_t released = 0;     //< number of deferred keys released since the constraint was created
+      std::size_t pending = 0;      //< number of keys currently deferred
+      double blocked_time = 0.0;    //< seconds the released keys spent deferred, summed over all keys
+    };
+
+    /// @return statistics of the deferred keys
+    stats_t stats() {
+      stats_t stats;
+      {
+        auto locks = lock_shards();
+        stats.blocked_time = m_blocked_time;
+      }
+      stats.deferred = m_num_deferred_total.load(std::memory_order_relaxed);
+      stats.released = m_num_released.load(std::memory_order_relaxed);
+      stats.pending = m_num_deferred.load(std::memory_order_relaxed);
+      return stats;
+    }
+
 
   protected:
-    std::map<ordinal_type, sequence_elem_t, compare_t> m_sequence;
+    std::unique_ptr<shard_t[]> m_shards = std::make_unique<shard_t[]>(num_shards);
     ordinal_type m_current = std::numeric_limits<ordinal_type>::min();
     [[no_unique_address]]
     Mapper m_map;
     [[no_unique_address]]
     compare_t m_order;
     std::atomic<std::size_t> m_active;
+    std::atomic<std::size_t> m_num_deferred = 0;
+    std::atomic<std::size_t> m_num_deferred_total = 0;
+    std::atomic<std::size_t> m_num_released = 0;
+    double m_blocked_time = 0.0; //< protected by the shard locks
+    std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
     bool m_stopped = false;
     bool m_auto_release = false;
   };
@@ -380,6 +503,297 @@ namespace ttg {
   SequencedKeysConstraint(const SequencedKeysConstraint<Key, Ordinal, Compare, Mapper>&)
     -> SequencedKeysConstraint<Key, Ordinal, Compare, Mapper>;
 
+  /**
+   * Base class of constraints that admit keys based on the number of tasks they currently track
+   * (i.e., tasks that passed the constraint but have not completed yet). Deferred keys are kept
+   * in a FIFO queue and released in the order they were deferred, in batches per TT.
+   * Derived classes provide \c admit(active), which decides whether another task may become active,
+   * and \c release_limit(), the maximum number of deferred keys released at once.
+   */
+  template<typename Key, typename Derived>
+  struct ActiveKeysConstraint : public ConstraintBase<Key> {
+
+    using key_type = std::conditional_t<ttg::meta::is_void_v<Key>, ttg::Void, Key>;
+    using base_t = ConstraintBase<Key>;
+
+  protected:
+
+    Derived& derived() {
+      return static_cast<Derived&>(*this);
+    }
+
+    /* try to account for one more active task, fails if the derived constraint does not admit it */
+    bool try_activate() {
+      /* sequentially consistent so that it is ordered with the publication of deferred keys, see check_key_impl */
+      auto active = m_active.load(std::memory_order_seq_cst);
+      while (derived().admit(active)) {
+        if (m_active.compare_exchange_weak(active, active+1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool check_key_impl(const key_type& key, ttg::TTBase *tt) {
+      /* deferred keys go first */
+      if (0 == m_num_deferred.load(std::memory_order_acquire) && try_activate()) {
+        return true;
+      }
+      // key should be deferred
+      auto g = this->lock_guard();
+      if (m_deferred.empty()) {
+        /* Tasks may have completed since we checked, and completing tasks check for deferred keys
+         * without the lock. Publish the deferral before retrying: a task completing concurrently
+         * either released its slot before we retry or sees the deferral and waits for the lock. */
+        m_num_deferred.store(1, std::memory_order_seq_cst);
+        if (try_activate()) {
+          m_num_deferred.store(0, std::memory_order_release);
+          return true;
+        }
+      }
+      m_deferred.emplace_back(tt, key);
+      m_num_deferred.store(m_deferred.size(), std::memory_order_release);
+      return false;
+    }
+
+    void complete_key_impl() {
+      m_active.fetch_sub(1, std::memory_order_seq_cst);
+      release_deferred();
+    }
+
+    /* release as many deferred keys as the derived constraint admits */
+    void release_deferred() {
+      if (0 == m_num_deferred.load(std::memory_order_seq_cst)) {
+        return; // nothing to be done
+      }
+      std::map<ttg::TTBase*, std::vector<key_type>> keys;
+      {
+        auto g = this->lock_guard();
+        std::size_t limit = derived().release_limit();
+        std::size_t num_released = 0;
+        while (!m_deferred.empty() && num_released < limit && try_activate()) {
+          auto& [tt, key] = m_deferred.front();
+          keys[tt].push_back(std::move(key));
+          m_deferred.pop_front();
+          ++num_released;
+        }
+        m_num_deferred.store(m_deferred.size(), std::memory_order_release);
+      }
+      for (auto& [tt, ttkeys] : keys) {
+        this->notify_listener(ttg::span<key_type>(ttkeys.data(), ttkeys.size()), tt);
+      }
+    }
+
+  public:
+
+    ActiveKeysConstraint() = default;
+
+    ActiveKeysConstraint(ActiveKeysConstraint&& akc)
+    : base_t(std::move(akc))
+    , m_deferred(std::move(akc.m_deferred))
+    , m_active(akc.m_active.load())
+    , m_num_deferred(akc.m_num_deferred.load())
+    { }
+
+    virtual ~ActiveKeysConstraint() = default;
+
+    template<typename Key_ = key_type>
+    std::enable_if_t<!ttg::meta::is_void_v<Key_>, bool>
+    check(const key_type& key, ttg::TTBase *tt) {
+      return this->check_key_impl(key, tt);
+    }
+
+    template<typename Key_ = key_type>
+    std::enable_if_t<ttg::meta::is_void_v<Key_>, bool>
+    check(ttg::TTBase *tt) {
+      return this->check_key_impl(ttg::Void{}, tt);
+    }
+
+    template<typename Key_ = key_type>
+    std::enable_if_t<!ttg::meta::is_void_v<Key_>>
+    complete(const key_type& key, ttg::TTBase *tt) {
+      this->complete_key_impl();
+    }
+
+    template<typename Key_ = key_type>
+    std::enable_if_t<ttg::meta::is_void_v<Key_>>
+    complete(ttg::TTBase *tt) {
+      this->complete_key_impl();
+    }
+
+    /// @return the number of tasks that passed the constraint and have not completed yet
+    std::size_t num_active() const {
+      return m_active.load(std::memory_order_relaxed);
+    }
+
+    /// @return the number of keys currently deferred by the constraint
+    std::size_t num_deferred() const {
+      return m_num_deferred.load(std::memory_order_relaxed);
+    }
+
+  protected:
+    std::deque<std::pair<ttg::TTBase*, key_type>> m_deferred; //< protected by the mutex
+    std::atomic<std::size_t> m_active = 0;
+    std::atomic<std::size_t> m_num_deferred = 0;
+  };
+
+  /**
+   * Limits the number of tasks that are active at the same time, i.e., tasks that passed the constraint
+   * and did not complete yet. Keys of tasks exceeding the limit are deferred and released in the order they
+   * arrived once active tasks complete. A constraint shared between multiple TTs (see \c make_shared_constraint)
+   * limits the number of active tasks across all of them.
+   *
+   * Example:
+   * // at most 4 tasks of tt_a and tt_b combined
+   * auto c = ttg::make_shared_constraint<ttg::MaxConcurrencyConstraint<Key>>(4);
+   * tt_a->add_constraint(c);
+   * tt_b->add_constraint(c);
+   */
+  template<typename Key>
+  struct MaxConcurrencyConstraint : public ActiveKeysConstraint<Key, MaxConcurrencyConstraint<Key>> {
+
+    using base_t = ActiveKeysConstraint<Key, MaxConcurrencyConstraint<Key>>;
+    using key_type = typename base_t::key_type;
+
+    /**
+     * @param max_active the maximum number of concurrently active tasks, at least 1
+     */
+    MaxConcurrencyConstraint(std::size_t max_active)
+    : base_t()
+    , m_max_active(std::max<std::size_t>(max_active, 1))
+    { }
+
+    MaxConcurrencyConstraint(MaxConcurrencyConstraint&& mcc)
+    : base_t(std::move(mcc))
+    , m_max_active(mcc.m_max_active.load())
+    { }
+
+    virtual ~MaxConcurrencyConstraint() = default;
+
+    /// @return the maximum number of concurrently active tasks
+    std::size_t max_active() const {
+      return m_max_active.load(std::memory_order_relaxed);
+    }
+
+    /// Changes the maximum number of concurrently active tasks (at least 1), raising it releases deferred keys
+    void set_max_active(std::size_t max_active) {
+      m_max_active.store(std::max<std::size_t>(max_active, 1), std::memory_order_relaxed);
+      this->release_deferred();
+    }
+
+    /* used by the base class */
+    bool admit(std::size_t active) const {
+      return active < m_max_active.load(std::memory_order_relaxed);
+    }
+
+    std::size_t release_limit() const {
+      return std::numeric_limits<std::size_t>::max();
+    }
+
+  private:
+    std::atomic<std::size_t> m_max_active;
+  };
+
+  /**
+   * Defers tasks while the memory in use exceeds a budget, which keeps eager producers from
+   * allocating data faster than their consumers release it. By default, the memory in use is
+   * the number of bytes held by the live data copies of the runtime (see \c ttg::live_data_bytes),
+   * which is only tracked by backends that manage data copies; a different measure can be provided.
+   *
+   * Deferred keys are released in the order they arrived, at most \c batch_size() keys
+   * whenever a task tracked by the constraint completes and the memory in use is within the budget.
+   * To guarantee progress, a task is always admitted if no task tracked by the constraint is active,
+   * since there is no guarantee that any other task will release memory.
+   */
+  template<typename Key>
+  struct MemoryBudgetConstraint : public ActiveKeysConstraint<Key, MemoryBudgetConstraint<Key>> {
+
+    using base_t = ActiveKeysConstraint<Key, MemoryBudgetConstraint<Key>>;
+    using key_type = typename base_t::key_type;
+    using usage_t = std::function<std::size_t()>;
+
+    /**
+     * Measures the memory in use with \c ttg::live_data_bytes, which enables the accounting of data copies
+     * while the constraint exists.
+     * @param budget the number of bytes beyond which tasks are deferred
+     */
+    MemoryBudgetConstraint(std::size_t budget)
+    : base_t()
+    , m_budget(budget)
+    , m_usage(&ttg::live_data_bytes)
+    , m_tracks_live_data(true)
+    {
+      ttg::detail::live_data_bytes_users.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @param budget the number of bytes beyond which tasks are deferred
+     * @param usage returns the number of bytes currently in use
+     */
+    MemoryBudgetConstraint(std::size_t budget, usage_t usage)
+    : base_t()
+    , m_budget(budget)
+    , m_usage(std::move(usage))
+    { }
+
+    MemoryBudgetConstraint(MemoryBudgetConstraint&& mbc)
+    : base_t(std::move(mbc))
+    , m_budget(mbc.m_budget.load())
+    , m_usage(std::move(mbc.m_usage))
+    , m_batch_size(mbc.m_batch_size)
+    , m_tracks_live_data(std::exchange(mbc.m_tracks_live_data, false))
+    { }
+
+    virtual ~MemoryBudgetConstraint() {
+      if (m_tracks_live_data) {
+        ttg::detail::live_data_bytes_users.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+
+    /// @return the number of bytes beyond which tasks are deferred
+    std::size_t budget() const {
+      return m_budget.load(std::memory_order_relaxed);
+    }
+
+    /// Changes the budget, raising it releases deferred keys
+    void set_budget(std::size_t budget) {
+      m_budget.store(budget, std::memory_order_relaxed);
+      release();
+    }
+
+    /// @return the maximum number of deferred keys released at once
+    std::size_t batch_size() const {
+      return m_batch_size;
+    }
+
+    /// Sets the maximum number of deferred keys released at once (at least 1), must not be called concurrently with task execution
+    void set_batch_size(std::size_t batch_size) {
+      m_batch_size = std::max<std::size_t>(batch_size, 1);
+    }
+
+    /// Releases deferred keys if the memory in use is within the budget, e.g., after memory was released
+    /// outside of the tasks tracked by this constraint
+    void release() {
+      this->release_deferred();
+    }
+
+    /* used by the base class */
+    bool admit(std::size_t active) const {
+      return (0 == active || m_usage() <= m_budget.load(std::memory_order_relaxed));
+    }
+
+    /* released keys are not yet reflected in the usage, so release a limited number at once */
+    std::size_t release_limit() const {
+      return m_batch_size;
+    }
+
+  private:
+    std::atomic<std::size_t> m_budget;
+    usage_t m_usage;
+    std::size_t m_batch_size = 16;
+    bool m_tracks_live_data = false; //< whether this constraint enabled the accounting of data copies
+  };
+
   /**
    * Make a constraint that can be shared between multiple TT instances.
    * Overload for incomplete templated constraint types.
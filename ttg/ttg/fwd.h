@@ -6,6 +6,8 @@
  * Includes forward declarations for the entire TTG codebase
  */
 
+#include <future>
+
 // namespaces first ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /// top-level TTG namespace contains runtime-neutral functionality
@@ -52,6 +54,7 @@ namespace ttg {
   World default_execution_context();
   void execute(ttg::World world);
   void fence(ttg::World world);
+  std::future<void> fence_async(ttg::World world);
 
 }  // namespace ttg
 
@@ -0,0 +1,91 @@
+#ifndef TTG_MADNESS_SPLITMD_H
+#define TTG_MADNESS_SPLITMD_H
+
+#include <cassert>
+#include <optional>
+#include <type_traits>
+
+#include "ttg/serialization/splitmd_data_descriptor.h"
+#include "ttg/serialization/traits.h"
+
+namespace ttg_madness {
+
+  namespace detail {
+
+    /**
+     * Wraps a value of a type with split metadata (see ttg::SplitMetadataDescriptor) for a remote transfer.
+     * Only the metadata is serialized; the payload is written straight from the iovecs of the sent value
+     * and read straight into the iovecs of the object created from the metadata on the receiving process
+     * (drawn from the recycling pool of the type, if it has one). The value itself is never serialized.
+     */
+    template <typename T>
+    class splitmd_value {
+     public:
+      using value_type = T;
+
+      splitmd_value() = default;
+
+      /// wraps a value to be sent, which must outlive the serialization of the wrapper
+      explicit splitmd_value(const T &value) : m_ptr(&value) {}
+
+      /// @return the received object, which the receiving TT may move from
+      T &get() {
+        assert(m_value.has_value());
+        return *m_value;
+      }
+
+#if defined(TTG_SERIALIZATION_SUPPORTS_MADNESS)
+      template <typename Archive>
+      std::enable_if_t<std::is_base_of_v<madness::archive::BufferInputArchive, Archive> ||
+                       std::is_base_of_v<madness::archive::BufferOutputArchive, Archive>>
+      serialize(Archive &ar) {
+        ttg::SplitMetadataDescriptor<T> descr;
+        if constexpr (ttg::detail::is_output_archive_v<Archive>) {
+          assert(nullptr != m_ptr);
+          auto metadata = descr.get_metadata(*m_ptr);
+          ar & metadata;
+          for (auto &&iov : descr.get_data(const_cast<T &>(*m_ptr))) {
+            ar << madness::archive::wrap(static_cast<const unsigned char *>(iov.data), iov.num_bytes);
+          }
+        } else {
+          ttg::split_metadata_t<T> metadata;
+          ar & metadata;
+          if constexpr (ttg::has_recycling_pool<T>::value) {
+            m_value.emplace(descr.create_from_metadata(metadata, ttg::recycling_pool<T>()));
+          } else {
+            m_value.emplace(descr.create_from_metadata(metadata));
+          }
+          for (auto &&iov : descr.get_data(*m_value)) {
+            ar >> madness::archive::wrap(static_cast<unsigned char *>(iov.data), iov.num_bytes);
+          }
+        }
+      }
+#endif  // TTG_SERIALIZATION_SUPPORTS_MADNESS
+
+     private:
+      const T *m_ptr = nullptr;          //< the sent value
+      std::optional<T> m_value;          //< the received value, handed over to the task by the receiving TT
+    };
+
+    template <typename T>
+    inline constexpr bool is_splitmd_value_v = false;
+
+    template <typename T>
+    inline constexpr bool is_splitmd_value_v<splitmd_value<T>> = true;
+
+    /* the received value of v */
+    template <typename T>
+    const T &unwrap_value(const T &v) {
+      return v;
+    }
+
+    template <typename T>
+    T &unwrap_value(splitmd_value<T> &v) {
+      return v.get();
+    }
+
+  }  // namespace detail
+
+}  // namespace ttg_madness
+
+#endif  // TTG_MADNESS_SPLITMD_H
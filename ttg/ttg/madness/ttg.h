@@ -10,15 +10,18 @@
 
 #include "ttg/base/keymap.h"
 #include "ttg/base/tt.h"
+#include "ttg/constraint.h"
 #include "ttg/func.h"
 #include "ttg/madness/device.h"
 #include "ttg/madness/devicefunc.h"
+#include "ttg/madness/splitmd.h"
 
 /* needed for make_tt */
 #include "ttg/device/task.h"
 
 #include "ttg/runtimes.h"
 #include "ttg/tt.h"
+#include "ttg/util/block_freelist.h"
 #include "ttg/util/bug.h"
 #include "ttg/util/env.h"
 #include "ttg/util/hash.h"
@@ -33,6 +36,7 @@
 /* include ttg header to make symbols available in case this header is included directly */
 #include "../../ttg.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <functional>
@@ -70,6 +74,12 @@ namespace ttg_madness {
   };
 #endif
 
+  namespace detail {
+    /* number of task bodies running on top of each other on this thread, across all TTs;
+     * nonzero while a task body (and anything it makes ready) executes */
+    inline thread_local std::size_t call_depth = 0;
+  }  // namespace detail
+
   class WorldImpl final : public ttg::base::WorldImplBase {
    private:
     ::madness::World &m_impl;
@@ -149,6 +159,7 @@ namespace ttg_madness {
     // World executes tasks eagerly
   }
   inline void ttg_fence(ttg::World world) { world.impl().fence(); }
+  inline std::future<void> ttg_fence_async(ttg::World world) { return world.impl().fence_async(); }
 
   template <typename T>
   inline void ttg_register_ptr(ttg::World world, const std::shared_ptr<T> &ptr) {
@@ -247,10 +258,12 @@ namespace ttg_madness {
     static constexpr int numins = std::tuple_size_v<actual_input_tuple_type>;  // number of input arguments
     static constexpr int numouts = std::tuple_size_v<output_terminalsT>;       // number of outputs
 
-    // This to support tt fusion
+    // maximum number of tasks executed directly on top of each other, see set_execution()
+    static constexpr std::size_t max_call_depth = 6;
+
+    // This to support tt fusion, see also detail::call_depth
     inline static __thread struct {
       uint64_t key_hash = 0;  // hash of current key
-      size_t call_depth = 0;  // how deep calls are nested
     } threaddata;
 
    public:
@@ -291,6 +304,15 @@ namespace ttg_madness {
    protected:
     const auto &get_output_terminals() const { return output_terminals; }
 
+    // std::tuple<std::vector<Ts>...> for std::tuple<Ts...>
+    template <typename Tuple>
+    struct vectors_tuple;
+    template <typename... Ts>
+    struct vectors_tuple<std::tuple<Ts...>> {
+      using type = std::tuple<std::vector<Ts>...>;
+    };
+    using input_queues_tuple_type = typename vectors_tuple<input_values_tuple_type>::type;
+
    private:
     struct TTArgs : ::madness::TaskInterface {
      private:
@@ -306,6 +328,8 @@ namespace ttg_madness {
       std::array<std::size_t, numins> stream_size;  // Expected number of values to receive, to be used for streaming
                                                     // inputs (0 = unbounded stream, >0 = bounded stream)
       input_values_tuple_type input_values;         // The input values (does not include control)
+      input_queues_tuple_type input_queues;         // Contributions to streaming inputs waiting to be reduced
+      std::array<bool, numins> reducing;            // Whether a reduction task drains the contributions to an input
       derivedT *derived;                            // Pointer to derived class instance
       bool pull_terminals_invoked = false;
       std::conditional_t<ttg::meta::is_void_v<keyT>, ttg::Void, keyT> key;  // Task key
@@ -332,14 +356,16 @@ namespace ttg_madness {
           , counter(numins)
           , nargs()
           , stream_size()
-          , input_values() {
+          , input_values()
+          , input_queues()
+          , reducing() {
         std::fill(nargs.begin(), nargs.end(), std::numeric_limits<std::int64_t>::max());
       }
 
       virtual void run(::madness::World &world) override {
         using ttg::hash;
         ttT::threaddata.key_hash = hash<decltype(key)>{}(key);
-        ttT::threaddata.call_depth++;
+        detail::call_depth++;
 
         void *suspended_task_address =
 #ifdef TTG_HAVE_COROUTINE
@@ -384,10 +410,10 @@ namespace ttg_madness {
 #endif // TTG_HAVE_COROUTINE
         }
 
-        ttT::threaddata.call_depth--;
+        detail::call_depth--;
 
         // if (suspended_task_address == nullptr) {
-        //   ttg::print("finishing task",ttT::threaddata.call_depth);
+        //   ttg::print("finishing task",detail::call_depth);
         // }
 
 #ifdef TTG_HAVE_COROUTINE
@@ -419,10 +445,24 @@ namespace ttg_madness {
           }
         }
 #endif  // TTG_HAVE_COROUTINE
+
+        // the task is complete, let the constraints release deferred tasks
+        static_cast<ttT *>(derived)->complete_constraints(this);
       }
 
       virtual ~TTArgs() {}  // Will be deleted via TaskInterface*
 
+      // task objects are allocated from and released to per-thread freelists (one per TT type),
+      // avoiding a trip to the heap for every task
+      static void *operator new(std::size_t size) {
+        assert(size == sizeof(TTArgs));
+        return ttg::detail::block_freelist<sizeof(TTArgs), alignof(TTArgs)>::allocate();
+      }
+
+      static void operator delete(void *ptr) {
+        ttg::detail::block_freelist<sizeof(TTArgs), alignof(TTArgs)>::deallocate(ptr);
+      }
+
      private:
       ::madness::Spinlock lock_;  // synchronizes access to data
      public:
@@ -435,6 +475,176 @@ namespace ttg_madness {
     using accessorT = typename cacheT::accessor;
     cacheT cache;
 
+    // tasks deferred by a constraint, until the constraint releases them (see add_constraint())
+    // a null entry records a release that overtook the parking of the task
+    cacheT constraint_cache;
+    std::vector<ttg::meta::detail::constraint_callback_t<keyT>> constraints_check;
+    std::vector<ttg::meta::detail::constraint_callback_t<keyT>> constraints_complete;
+
+    static hashable_keyT constraint_key(const TTArgs *args) {
+      if constexpr (ttg::meta::is_void_v<keyT>) {
+        return 0;
+      } else {
+        return args->key;
+      }
+    }
+
+    // returns the index of the first constraint, starting at first, that defers the task with the given key,
+    // or the number of constraints if none does
+    std::size_t check_constraints(const hashable_keyT &key, std::size_t first = 0) {
+      for (std::size_t i = first; i < constraints_check.size(); ++i) {
+        bool pass;
+        if constexpr (ttg::meta::is_void_v<keyT>) {
+          pass = constraints_check[i]();
+        } else {
+          pass = constraints_check[i](key);
+        }
+        if (!pass) return i;
+      }
+      return constraints_check.size();
+    }
+
+    // parks a task deferred by a constraint, returns false if the constraint released it in the meantime
+    bool park_task(TTArgs *args) {
+      accessorT acc;
+      if (!constraint_cache.insert(acc, constraint_key(args))) {
+        assert(acc->second == nullptr);
+        constraint_cache.erase(acc);
+        return false;
+      }
+      acc->second = args;
+      return true;
+    }
+
+    // schedules the tasks released by constraint cid, unless a subsequent constraint defers them
+    void release_constraint(std::size_t cid, const ttg::span<hashable_keyT> &keys) {
+      assert(cid < constraints_check.size());
+      for (auto &key : keys) {
+        if (check_constraints(key, cid + 1) < constraints_check.size()) continue;  // deferred by another constraint
+        TTArgs *args = nullptr;
+        {
+          accessorT acc;
+          if (constraint_cache.insert(acc, key)) {
+            // the task has not been parked yet, leave a note for park_task()
+            acc->second = nullptr;
+          } else {
+            args = acc->second;
+            constraint_cache.erase(acc);
+          }
+        }
+        // released tasks are always enqueued since we are called from within the constraint
+        if (nullptr != args) world.impl().impl().taskq.add(args);
+      }
+    }
+
+    void release_constraint(std::size_t cid) {
+      hashable_keyT key = 0;
+      release_constraint(cid, ttg::span<hashable_keyT>(&key, 1));
+    }
+
+    // notifies the constraints that the task completed
+    void complete_constraints(const TTArgs *args) {
+      for (auto &c : constraints_complete) {
+        if constexpr (ttg::meta::is_void_v<keyT>) {
+          c();
+        } else {
+          c(args->key);
+        }
+      }
+    }
+
+    // submits a ready task, unless a constraint defers it
+    void submit(TTArgs *args) {
+      if (!constraints_check.empty() && check_constraints(constraint_key(args)) < constraints_check.size() &&
+          park_task(args)) {
+        return;  // will be enqueued once released by the constraint
+      }
+      schedule(args);
+    }
+
+    // enqueues a ready task, or executes it right away if the execution policy is Inline and the task
+    // was made ready by the body of a running task (never by active message handlers or the main thread)
+    // and the call depth permits
+    void schedule(TTArgs *args) {
+      if (this->get_execution() == ttg::Execution::Inline && detail::call_depth > 0 &&
+          detail::call_depth < max_call_depth) {
+        args->run(world.impl().impl());
+        delete args;  // not owned by the task queue
+      } else {
+        world.impl().impl().taskq.add(args);
+      }
+    }
+
+    // drains the contributions to streaming input i of a task, see reduce_stream()
+    template <std::size_t i>
+    struct StreamReductionTask : ::madness::TaskInterface {
+      ttT *tt;
+      hashable_keyT key;
+
+      StreamReductionTask(ttT *tt, const hashable_keyT &key, bool high_priority)
+          : ::madness::TaskInterface(
+                ::madness::TaskAttributes(high_priority ? ::madness::TaskAttributes::HIGHPRIORITY : 0))
+          , tt(tt)
+          , key(key) {}
+
+      virtual void run(::madness::World &world) override { tt->template reduce_stream<i>(key); }
+    };
+
+    // reduces the queued contributions to streaming input i of the task with the given key until the queue is empty,
+    // so that contributors only ever wait for the queue to be updated, and submits the task if it becomes ready
+    template <std::size_t i>
+    void reduce_stream(const hashable_keyT &key) {
+      using valueT = std::decay_t<std::tuple_element_t<i, input_values_full_tuple_type>>;
+      const auto &reducer = std::get<i>(input_reducers);
+      std::vector<valueT> values;
+      while (true) {
+        TTArgs *args;
+        {
+          accessorT acc;
+          [[maybe_unused]] const auto found = cache.find(acc, key);
+          assert(found && "TT::reduce_stream: the task is gone while contributions are pending");
+          args = acc->second;
+          args->lock();
+          auto &queue = std::get<i>(args->input_queues);
+          if (queue.empty()) {
+            args->reducing[i] = false;
+            // is this the last message?
+            if (args->nargs[i] == 0) args->counter--;
+            args->unlock();
+
+            // If lazy pulling in enabled, check it here.
+            if (numins - args->counter == num_pullins) {
+              if constexpr (!ttg::meta::is_void_v<keyT>) {
+                if (is_lazy_pull() && !args->pull_terminals_invoked) {
+                  invoke_pull_terminals(std::make_index_sequence<std::tuple_size_v<input_values_tuple_type>>{}, key,
+                                        args);
+                }
+              }
+            }
+
+            // ready to run the task?
+            if (args->counter == 0) {
+              ttg::trace(world.rank(), ":", get_name(), " : submitting task for op after reducing stream ", i);
+              args->derived = static_cast<derivedT *>(this);
+              if constexpr (!ttg::meta::is_void_v<keyT>) args->key = key;
+              cache.erase(acc);
+              submit(args);
+            }
+            return;
+          }
+          // take the contributions, leaving our (empty) storage behind for the contributors
+          values.swap(queue);
+          args->unlock();
+        }
+        // only this task accesses the value while the input is being reduced
+        auto &target = this->get<i, valueT &>(args->input_values);
+        for (auto &value : values) {
+          reducer(target, value);
+        }
+        values.clear();
+      }
+    }
+
    protected:
     template <typename terminalT, std::size_t i, typename Key>
     void invoke_pull_terminal(terminalT &in, const Key &key, TTArgs *args) {
@@ -539,14 +749,21 @@ namespace ttg_madness {
         // move arguments) and locally
         //      here we know that this will be a remove execution, so we prepare to take rvalues;
         //      send_am will need to separate local and remote paths to deal with this
+        //      values with split metadata only have their metadata serialized, see detail::splitmd_value
         if constexpr (!ttg::meta::is_void_v<Key>) {
-          if constexpr (!ttg::meta::is_void_v<Value>) {
+          if constexpr (!ttg::meta::is_void_v<Value> && ttg::has_split_metadata<std::decay_t<Value>>::value) {
+            worldobjT::send(owner, &ttT::template set_arg_splitmd<i, Key, std::decay_t<Value>>, key,
+                            detail::splitmd_value<std::decay_t<Value>>(value));
+          } else if constexpr (!ttg::meta::is_void_v<Value>) {
             worldobjT::send(owner, &ttT::template set_arg<i, Key, const std::remove_reference_t<Value> &>, key, value);
           } else {
             worldobjT::send(owner, &ttT::template set_arg<i, Key, void>, key);
           }
         } else {
-          if constexpr (!ttg::meta::is_void_v<Value>) {
+          if constexpr (!ttg::meta::is_void_v<Value> && ttg::has_split_metadata<std::decay_t<Value>>::value) {
+            worldobjT::send(owner, &ttT::template set_arg_splitmd_nokey<i, std::decay_t<Value>>,
+                            detail::splitmd_value<std::decay_t<Value>>(value));
+          } else if constexpr (!ttg::meta::is_void_v<Value>) {
             worldobjT::send(owner, &ttT::template set_arg<i, void, const std::remove_reference_t<Value> &>, value);
           } else {
             worldobjT::send(owner, &ttT::template set_arg<i, void, void>);
@@ -585,8 +802,9 @@ namespace ttg_madness {
 
         const auto &reducer = std::get<i>(input_reducers);
         if (reducer) {  // is this a streaming input? reduce the received value
-          // N.B. Right now reductions are done eagerly, without spawning tasks
-          //      this means we must lock
+          // N.B. contributions are queued and reduced by a separate task (see reduce_stream),
+          //      the lock only protects the queue and the counters
+          bool spawn_reduction = false;
           args->lock();
 
           bool initialize_not_reduce = false;
@@ -611,10 +829,15 @@ namespace ttg_madness {
           }
 
           if constexpr (!ttg::meta::is_void_v<valueT>) {  // for data values
-            if (initialize_not_reduce)
+            if (initialize_not_reduce) {
               this->get<i, std::decay_t<valueT> &>(args->input_values) = std::forward<Value>(value);
-            else
-              reducer(this->get<i, std::decay_t<valueT> &>(args->input_values), value);
+            } else {
+              std::get<i>(args->input_queues).emplace_back(std::forward<Value>(value));
+              if (!args->reducing[i]) {
+                args->reducing[i] = true;
+                spawn_reduction = true;
+              }
+            }
           } else {
             reducer();  // even if this was a control input, must execute the reducer for possible side effects
           }
@@ -622,10 +845,20 @@ namespace ttg_madness {
           // update the counter
           args->nargs[i]--;
 
-          // is this the last message?
-          if (args->nargs[i] == 0) args->counter--;
+          // is this the last message? if a reduction is pending the reduction task will update the counter
+          if (args->nargs[i] == 0 && !args->reducing[i]) args->counter--;
 
           args->unlock();
+
+          if (spawn_reduction) {
+            hashable_keyT hkey;
+            if constexpr (!ttg::meta::is_void_v<Key>) {
+              hkey = key;
+            } else {
+              hkey = 0;
+            }
+            world.impl().impl().taskq.add(new StreamReductionTask<i>(this, hkey, args->is_high_priority()));
+          }
         } else {                                          // this is a nonstreaming input => set the value
           if constexpr (!ttg::meta::is_void_v<valueT>) {  // for data values
             this->get<i, std::decay_t<valueT> &>(args->input_values) = std::forward<Value>(value);
@@ -651,10 +884,16 @@ namespace ttg_madness {
           using ttg::hash;
           auto curhash = hash<keyT>{}(key);
 
-          if (curhash == threaddata.key_hash && threaddata.call_depth < 6) {  // Needs to be externally configurable
+          if (this->get_execution() == ttg::Execution::Inline || !constraints_check.empty()) {
+            cache.erase(acc);
+            submit(args);
+            return;
+          }
+
+          if (curhash == threaddata.key_hash && detail::call_depth < max_call_depth) {
 
-            // ttg::print("directly invoking:", get_name(), key, curhash, threaddata.key_hash, threaddata.call_depth);
-            ttT::threaddata.call_depth++;
+            // ttg::print("directly invoking:", get_name(), key, curhash, threaddata.key_hash, detail::call_depth);
+            detail::call_depth++;
             if constexpr (!ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
               static_cast<derivedT *>(this)->op(key, args->make_input_refs(), output_terminals);  // Runs immediately
             } else if constexpr (!ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
@@ -665,10 +904,10 @@ namespace ttg_madness {
               static_cast<derivedT *>(this)->op(output_terminals);  // Runs immediately
             } else
               ttg::abort();
-            ttT::threaddata.call_depth--;
+            detail::call_depth--;
 
           } else {
-            // ttg::print("enqueuing task", get_name(), key, curhash, threaddata.key_hash, threaddata.call_depth);
+            // ttg::print("enqueuing task", get_name(), key, curhash, threaddata.key_hash, detail::call_depth);
             world.impl().impl().taskq.add(args);
           }
 
@@ -695,6 +934,92 @@ namespace ttg_madness {
       set_arg<i, ttg::Void, ttg::Void>(ttg::Void{}, ttg::Void{});
     }
 
+    // sets a value received with split metadata, handing the received object over to the task
+    template <std::size_t i, typename Key, typename Value>
+    void set_arg_splitmd(const Key &key, detail::splitmd_value<Value> &value) {
+      set_arg<i, Key, Value>(key, std::move(value.get()));
+    }
+
+    template <std::size_t i, typename Value>
+    void set_arg_splitmd_nokey(detail::splitmd_value<Value> &value) {
+      set_arg<i, void, Value>(std::move(value.get()));
+    }
+
+    // sets the value (if any) for all keys received in a single message by broadcast_arg()
+    template <std::size_t i, typename Key, typename Value>
+    void set_arg_keylist(const std::vector<Key> &keylist, Value &value) {
+      auto &v = detail::unwrap_value(value);
+      using valueT = std::decay_t<decltype(v)>;
+      if constexpr (detail::is_splitmd_value_v<Value>) {
+        // the received object is owned by the wrapper, the last task takes it over
+        for (std::size_t k = 0; k + 1 < keylist.size(); ++k) {
+          set_arg<i, Key, const valueT &>(keylist[k], v);
+        }
+        set_arg<i, Key, valueT>(keylist.back(), std::move(v));
+      } else {
+        for (const auto &key : keylist) {
+          set_arg<i, Key, const valueT &>(key, v);
+        }
+      }
+    }
+
+    template <std::size_t i, typename Key>
+    void set_arg_keylist(const std::vector<Key> &keylist) {
+      for (const auto &key : keylist) {
+        set_arg<i, Key, void>(key);
+      }
+    }
+
+    // sets the value (if any) for all keys in keylist: keys are grouped by owner and each remote
+    // process receives a single message carrying the value, serialized once, and all of its keys
+    template <std::size_t i, typename Key, typename... Value>
+    void broadcast_arg(const ttg::span<const Key> &keylist, const Value &...value) {
+      static_assert(sizeof...(Value) <= 1);
+      auto set_local_arg = [&](const Key &key) {
+        if constexpr (sizeof...(Value) == 0) {
+          set_arg<i, Key, void>(key);
+        } else {
+          set_arg<i, Key, const Value &...>(key, value...);
+        }
+      };
+      if (keylist.size() == 1) {
+        set_local_arg(keylist[0]);
+        return;
+      }
+      const int rank = world.rank();
+      // (owner, index) pairs, sorted by owner while keeping the order of the keys of each owner
+      std::vector<std::pair<int, std::size_t>> owners;
+      owners.reserve(keylist.size());
+      for (std::size_t k = 0; k < keylist.size(); ++k) {
+        owners.emplace_back(keymap(keylist[k]), k);
+      }
+      std::stable_sort(owners.begin(), owners.end(),
+                       [](const auto &a, const auto &b) { return a.first < b.first; });
+      // send to remote processes first so that they can start working while we process local keys
+      std::vector<Key> keys;
+      for (auto it = owners.begin(); it != owners.end();) {
+        const int owner = it->first;
+        auto end = std::find_if(it, owners.end(), [owner](const auto &o) { return o.first != owner; });
+        if (owner != rank) {
+          keys.clear();
+          for (; it != end; ++it) keys.push_back(keylist[it->second]);
+          ttg::trace(world.rank(), ":", get_name(), " : broadcasting to ", keys.size(), " keys on ", owner);
+          if constexpr (sizeof...(Value) == 0) {
+            worldobjT::send(owner, &ttT::template set_arg_keylist<i, Key>, keys);
+          } else if constexpr ((ttg::has_split_metadata<Value>::value && ...)) {
+            worldobjT::send(owner, &ttT::template set_arg_keylist<i, Key, detail::splitmd_value<Value>...>, keys,
+                            detail::splitmd_value<Value>(value)...);
+          } else {
+            worldobjT::send(owner, &ttT::template set_arg_keylist<i, Key, Value...>, keys, value...);
+          }
+        }
+        it = end;
+      }
+      for (auto &[owner, k] : owners) {
+        if (owner == rank) set_local_arg(keylist[k]);
+      }
+    }
+
     // Used by invoke to set all arguments associated with a task
     // Is: index sequence of elements in args
     // Js: index sequence of input terminals to set
@@ -783,8 +1108,8 @@ namespace ttg_madness {
           }
           args->nargs[i] += size;
         }
-        // if done, update the counter
-        if (args->nargs[i] == 0) args->counter--;
+        // if done, update the counter, unless a pending reduction will
+        if (args->nargs[i] == 0 && !args->reducing[i]) args->counter--;
         args->unlock();
 
         // ready to run the task?
@@ -792,9 +1117,8 @@ namespace ttg_madness {
           ttg::trace(world.rank(), ":", get_name(), " : submitting task for op ");
           args->derived = static_cast<derivedT *>(this);
 
-          world.impl().impl().taskq.add(args);
-
           cache.erase(acc);
+          submit(args);
         }
       }
     }
@@ -857,8 +1181,8 @@ namespace ttg_madness {
         // if messages already received for this key update the expected-received counter
         const auto messages_received_already = args->nargs[i] != std::numeric_limits<std::int64_t>::max();
         if (messages_received_already) args->nargs[i] += size;
-        // if done, update the counter
-        if (args->nargs[i] == 0) args->counter--;
+        // if done, update the counter, unless a pending reduction will
+        if (args->nargs[i] == 0 && !args->reducing[i]) args->counter--;
 
         args->unlock();
 
@@ -868,9 +1192,8 @@ namespace ttg_madness {
           args->derived = static_cast<derivedT *>(this);
           args->key = key;
 
-          world.impl().impl().taskq.add(args);
-
           cache.erase(acc);
+          submit(args);
         }
       }
     }
@@ -908,18 +1231,19 @@ namespace ttg_madness {
         }
 
         // commit changes
+        args->lock();
         args->nargs[i] = 0;
-        args->counter--;
+        // update the counter, unless a pending reduction will
+        if (!args->reducing[i]) args->counter--;
+        args->unlock();
         // ready to run the task?
         if (args->counter == 0) {
           ttg::trace(world.rank(), ":", get_name(), " : ", key, ": submitting task for op ");
           args->derived = static_cast<derivedT *>(this);
           args->key = key;
 
-          world.impl().impl().taskq.add(args);
-          // static_cast<derivedT*>(this)->op(key, std::move(args->t), output_terminals); // Runs immediately
-
           cache.erase(acc);
+          submit(args);
         }
       }
     }
@@ -957,17 +1281,18 @@ namespace ttg_madness {
         }
 
         // commit changes
+        args->lock();
         args->nargs[i] = 0;
-        args->counter--;
+        // update the counter, unless a pending reduction will
+        if (!args->reducing[i]) args->counter--;
+        args->unlock();
         // ready to run the task?
         if (args->counter == 0) {
           ttg::trace(world.rank(), ":", get_name(), " : submitting task for op ");
           args->derived = static_cast<derivedT *>(this);
 
-          world.impl().impl().taskq.add(args);
-          // static_cast<derivedT*>(this)->op(key, std::move(args->t), output_terminals); // Runs immediately
-
           cache.erase(acc);
+          submit(args);
         }
       }
     }
@@ -1009,9 +1334,12 @@ namespace ttg_madness {
         auto send_callback = [this](const keyT &key, const valueT &value) {
           set_arg<i, keyT, const valueT &>(key, value);
         };
+        auto broadcast_callback = [this](const ttg::span<const keyT> &keylist, const valueT &value) {
+          broadcast_arg<i, keyT, valueT>(keylist, value);
+        };
         auto setsize_callback = [this](const keyT &key, std::size_t size) { set_argstream_size<i>(key, size); };
         auto finalize_callback = [this](const keyT &key) { finalize_argstream<i>(key); };
-        input.set_callback(send_callback, move_callback, {}, setsize_callback, finalize_callback);
+        input.set_callback(send_callback, move_callback, broadcast_callback, setsize_callback, finalize_callback);
       }
       //////////////////////////////////////////////////////////////////
       // case 4: void key, nonvoid value
@@ -1030,9 +1358,10 @@ namespace ttg_madness {
       //////////////////////////////////////////////////////////////////
       else if constexpr (!ttg::meta::is_void_v<keyT> && std::is_void_v<valueT>) {
         auto send_callback = [this](const keyT &key) { set_arg<i, keyT, void>(key); };
+        auto broadcast_callback = [this](const ttg::span<const keyT> &keylist) { broadcast_arg<i, keyT>(keylist); };
         auto setsize_callback = [this](const keyT &key, std::size_t size) { set_argstream_size<i>(key, size); };
         auto finalize_callback = [this](const keyT &key) { finalize_argstream<i>(key); };
-        input.set_callback(send_callback, send_callback, {}, setsize_callback, finalize_callback);
+        input.set_callback(send_callback, send_callback, broadcast_callback, setsize_callback, finalize_callback);
       }
       //////////////////////////////////////////////////////////////////
       // case 5: void key, void value, mixed inputs
@@ -1213,21 +1542,56 @@ namespace ttg_madness {
       priomap = std::forward<Priomap>(pm);
     }
 
+    /// add a shared constraint
+    /// the constraint must provide a valid override of `check_key(key)`
+    /// ready tasks deferred by the constraint are held back until the constraint releases them
+    template<typename Constraint>
+    void add_constraint(std::shared_ptr<Constraint> c) {
+      std::size_t cid = constraints_check.size();
+      if constexpr(ttg::meta::is_void_v<keyT>) {
+        c->add_listener([this, cid](){ this->release_constraint(cid); }, this);
+        constraints_check.push_back([c, this](){ return c->check(this); });
+        constraints_complete.push_back([c, this](){ c->complete(this); return true; });
+      } else {
+        c->add_listener([this, cid](const ttg::span<keyT>& keys){ this->release_constraint(cid, keys); }, this);
+        constraints_check.push_back([c, this](const keyT& key){ return c->check(key, this); });
+        constraints_complete.push_back([c, this](const keyT& key){ c->complete(key, this); return true; });
+      }
+    }
+
     /// add a constraint
     /// the constraint must provide a valid override of `check_key(key)`
     template<typename Constraint>
     void add_constraint(Constraint&& c) {
-      /* currently a noop */
+      // need to make this a shared_ptr since it's shared between different callbacks
+      this->add_constraint(std::make_shared<Constraint>(std::forward<Constraint>(c)));
     }
 
+    /// add a shared constraint
+    /// the constraint must provide a valid override of `check_key(key, map(key))`
+    /// ths overload can be used to provide different key mapping functions for each TT
     template<typename Constraint, typename Mapper>
     void add_constraint(std::shared_ptr<Constraint> c, Mapper&& map) {
-      /* currently a noop */
+      static_assert(std::is_same_v<typename Constraint::key_type, keyT>);
+      std::size_t cid = constraints_check.size();
+      if constexpr(ttg::meta::is_void_v<keyT>) {
+        c->add_listener([this, cid](){ this->release_constraint(cid); }, this);
+        constraints_check.push_back([map, c, this](){ return c->check(map(), this); });
+        constraints_complete.push_back([map, c, this](){ c->complete(map(), this); return true; });
+      } else {
+        c->add_listener([this, cid](const ttg::span<keyT>& keys){ this->release_constraint(cid, keys); }, this);
+        constraints_check.push_back([map, c, this](const keyT& key){ return c->check(key, map(key), this); });
+        constraints_complete.push_back([map, c, this](const keyT& key){ c->complete(key, map(key), this); return true; });
+      }
     }
 
+    /// add a shared constraint
+    /// the constraint must provide a valid override of `check_key(key, map(key))`
+    /// ths overload can be used to provide different key mapping functions for each TT
     template<typename Constraint, typename Mapper>
     void add_constraint(Constraint c, Mapper&& map) {
-      /* currently a noop */
+      // need to make this a shared_ptr since it's shared between different callbacks
+      this->add_constraint(std::make_shared<Constraint>(std::forward<Constraint>(c)), std::forward<Mapper>(map));
     }
 
     /// implementation of TTBase::make_executable()
@@ -42,6 +42,8 @@ namespace ttg_parsec {
 
   inline void ttg_fence(ttg::World world);
 
+  inline std::future<void> ttg_fence_async(ttg::World world);
+
   template <typename T>
   inline void ttg_register_ptr(ttg::World world, const std::shared_ptr<T> &ptr);
 
@@ -0,0 +1,200 @@
+#ifndef TTG_PARSEC_MEMREG_CACHE_H
+#define TTG_PARSEC_MEMREG_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <parsec.h>
+#include <parsec/parsec_comm_engine.h>
+
+namespace ttg_parsec {
+
+  namespace detail {
+
+    // fwd-decl
+    struct ttg_data_copy_t;
+
+    /**
+     * Cache of memory registrations used for RMA-based (non-inline) transfers.
+     * Registrations are keyed on (ptr, size) and owned by the data copy holding the memory,
+     * i.e., they are dropped once the data copy is destroyed or its value may be modified
+     * (see ttg_data_copy_t::invalidate_memregs), as buffers may be reallocated at the same address. The total number of registered
+     * bytes is bounded by a capacity (see TTG_MEMREG_CACHE_SIZE), beyond which the least
+     * recently used registrations are evicted. Registrations still in use by an ongoing
+     * transfer are only unregistered once the transfer completes.
+     */
+    class memreg_cache {
+     public:
+      /* a registration handle, unregisters the memory once the last reference is dropped */
+      using handle_t = std::shared_ptr<void>;
+
+      struct stats_t {
+        std::size_t hits = 0;         //< number of registrations served from the cache
+        std::size_t misses = 0;       //< number of registrations that required a call to mem_register
+        std::size_t evictions = 0;    //< number of registrations evicted to stay within the capacity
+        std::size_t cached_bytes = 0; //< number of bytes currently registered through the cache
+      };
+
+      static memreg_cache& instance() {
+        static memreg_cache cache;
+        return cache;
+      }
+
+      /* maximum number of bytes kept registered, 0 disables caching */
+      void set_capacity(std::size_t capacity) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_capacity.store(capacity, std::memory_order_relaxed);
+        evict_lru();
+      }
+
+      std::size_t capacity() const {
+        return m_capacity.load(std::memory_order_relaxed);
+      }
+
+      /**
+       * Returns a registration handle and its size for the memory region [ptr, ptr+size)
+       * owned by copy, registering the memory with the comm engine if necessary.
+       * The handle can be used until the returned pointer is released.
+       */
+      std::pair<handle_t, int32_t> get(ttg_data_copy_t *copy, void *ptr, std::size_t size) {
+        std::size_t capacity = m_capacity.load(std::memory_order_relaxed);
+        if (0 == capacity || size > capacity) {
+          /* no caching */
+          m_misses.fetch_add(1, std::memory_order_relaxed);
+          return register_memory(ptr, size);
+        }
+        std::lock_guard<std::mutex> lock(m_mtx);
+        key_t key{ptr, size};
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+          if (it->second.copy == copy) {
+            /* move to the front of the LRU list */
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lru_it);
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return std::make_pair(it->second.handle, it->second.handle_size);
+          }
+          /* stale entry of a different copy that used the same memory */
+          erase(it);
+        }
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        auto [handle, handle_size] = register_memory(ptr, size);
+        m_lru.push_front(key);
+        m_entries.emplace(key, entry_t{handle, handle_size, copy, m_lru.begin()});
+        m_by_copy[copy].push_back(key);
+        m_cached_bytes += size;
+        evict_lru();
+        return std::make_pair(std::move(handle), handle_size);
+      }
+
+      /* drop all registrations owned by copy, called when the copy is destroyed */
+      void evict(ttg_data_copy_t *copy) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto it = m_by_copy.find(copy);
+        if (it == m_by_copy.end()) return;
+        auto keys = std::move(it->second);
+        m_by_copy.erase(it);
+        for (auto& key : keys) {
+          auto eit = m_entries.find(key);
+          if (eit != m_entries.end() && eit->second.copy == copy) {
+            m_cached_bytes -= key.size;
+            m_lru.erase(eit->second.lru_it);
+            m_entries.erase(eit);
+          }
+        }
+      }
+
+      /* drop all registrations, must be called before the comm engine is shut down */
+      void clear() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_entries.clear();
+        m_by_copy.clear();
+        m_lru.clear();
+        m_cached_bytes = 0;
+      }
+
+      stats_t stats() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return stats_t{m_hits.load(std::memory_order_relaxed), m_misses.load(std::memory_order_relaxed),
+                       m_evictions, m_cached_bytes};
+      }
+
+      /* registers memory that is not owned by a data copy, bypassing the cache */
+      static std::pair<handle_t, int32_t> register_memory(void *ptr, std::size_t size) {
+        parsec_ce_mem_reg_handle_t lreg;
+        size_t lreg_size;
+        parsec_ce.mem_register(ptr, PARSEC_MEM_TYPE_NONCONTIGUOUS, size, parsec_datatype_int8_t,
+                               size, &lreg, &lreg_size);
+        /* TODO: this assumes that parsec_ce_mem_reg_handle_t is void* */
+        return std::make_pair(handle_t{lreg, [](void *ptr) {
+                                         parsec_ce_mem_reg_handle_t memreg = (parsec_ce_mem_reg_handle_t)ptr;
+                                         parsec_ce.mem_unregister(&memreg);
+                                       }},
+                              static_cast<int32_t>(lreg_size));
+      }
+
+     private:
+      struct key_t {
+        void *ptr;
+        std::size_t size;
+        bool operator==(const key_t& other) const {
+          return ptr == other.ptr && size == other.size;
+        }
+      };
+
+      struct key_hash_t {
+        std::size_t operator()(const key_t& key) const {
+          std::size_t h = std::hash<void*>{}(key.ptr);
+          return h ^ (std::hash<std::size_t>{}(key.size) + 0x9e3779b9 + (h << 6) + (h >> 2));
+        }
+      };
+
+      struct entry_t {
+        handle_t handle;
+        int32_t handle_size;
+        ttg_data_copy_t *copy;
+        typename std::list<key_t>::iterator lru_it;
+      };
+
+      /* remove an entry, must be called with the mutex held */
+      template<typename Iterator>
+      void erase(Iterator it) {
+        auto& keys = m_by_copy[it->second.copy];
+        std::erase(keys, it->first);
+        if (keys.empty()) m_by_copy.erase(it->second.copy);
+        m_cached_bytes -= it->first.size;
+        m_lru.erase(it->second.lru_it);
+        m_entries.erase(it);
+      }
+
+      /* evict least recently used entries until we are within capacity, must be called with the mutex held */
+      void evict_lru() {
+        while (m_cached_bytes > m_capacity.load(std::memory_order_relaxed) && !m_lru.empty()) {
+          erase(m_entries.find(m_lru.back()));
+          ++m_evictions;
+        }
+      }
+
+      std::mutex m_mtx;
+      std::unordered_map<key_t, entry_t, key_hash_t> m_entries;
+      std::unordered_map<ttg_data_copy_t*, std::vector<key_t>> m_by_copy;
+      std::list<key_t> m_lru;
+      std::atomic<std::size_t> m_capacity = 1024UL*1024*1024;
+      std::size_t m_cached_bytes = 0;
+      std::size_t m_evictions = 0;
+      std::atomic<std::size_t> m_hits = 0;
+      std::atomic<std::size_t> m_misses = 0;
+    };
+
+  } // namespace detail
+
+} // namespace ttg_parsec
+
+#endif // TTG_PARSEC_MEMREG_CACHE_H
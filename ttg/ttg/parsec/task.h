@@ -3,6 +3,9 @@
 
 #include "ttg/parsec/ttg_data_copy.h"
 
+#include <atomic>
+#include <vector>
+
 #include <parsec/parsec_internal.h>
 #include <parsec/mca/device/device_gpu.h>
 
@@ -98,6 +101,8 @@ namespace ttg_parsec {
         std::size_t size;
         parsec_lifo_t reduce_copies;
         std::atomic<std::size_t> reduce_count;
+        std::atomic<int> combiners;                     //< senders combining contributions (tree reductions)
+        std::vector<ttg_data_copy_t*> *ordered_copies;  //< contributions buffered for an ordered reduction
       };
 
     protected:
@@ -109,6 +114,8 @@ namespace ttg_parsec {
             streams[i].size = 0;
             PARSEC_OBJ_CONSTRUCT(&streams[i].reduce_copies, parsec_lifo_t);
             streams[i].reduce_count.store(0, std::memory_order_relaxed);
+            streams[i].combiners.store(0, std::memory_order_relaxed);
+            streams[i].ordered_copies = nullptr;
           }
           /* recursion */
           if constexpr((i + 1) < TT::numins) {
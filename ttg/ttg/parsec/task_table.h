@@ -0,0 +1,308 @@
+#ifndef TTG_PARSEC_TASK_TABLE_H
+#define TTG_PARSEC_TASK_TABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "ttg/parsec/task.h"
+#include "ttg/util/meta.h"
+#include "ttg/util/multiindex.h"
+
+#include <parsec/class/parsec_hash_table.h>
+
+namespace ttg_parsec {
+
+  namespace detail {
+
+    template <typename T>
+    struct is_multiindex : std::false_type {};
+
+    template <std::size_t Rank, typename Int>
+    struct is_multiindex<ttg::MultiIndex<Rank, Int>> : std::true_type {
+      static constexpr std::size_t rank = Rank;
+      using index_type = Int;
+    };
+
+    template <typename T>
+    constexpr bool is_multiindex_v = is_multiindex<T>::value;
+
+    /* whether task tables count their tasks and measure the time spent waiting for locks (see TTG_TASK_TABLE_STATS),
+     * off by default since the counters are updated for every task */
+    inline bool task_table_timing = false;
+
+    /* statistics of a task table */
+    struct task_table_stats_t {
+      std::size_t num_shards = 0;         //< number of hash tables the keys are distributed over
+      std::size_t num_buckets = 0;        //< initial number of buckets, summed over all shards
+      std::size_t inserts = 0;            //< number of tasks inserted into the table, only counted if task_table_timing is set
+      std::size_t pending = 0;            //< number of tasks currently in the table, only counted if task_table_timing is set
+      std::size_t max_pending = 0;        //< largest number of tasks observed in a shard, times the number of shards,
+                                          //< only counted if task_table_timing is set
+      std::size_t contended_locks = 0;    //< number of slot locks of the dense table that had to be waited for
+      double lock_wait_time = 0.0;        //< seconds spent acquiring locks, only measured if task_table_timing is set
+      /* average number of pending tasks per bucket at the peak, i.e., the expected length of the probed chains */
+      double max_load() const { return num_buckets > 0 ? static_cast<double>(max_pending) / num_buckets : 0.0; }
+    };
+
+    /**
+     * Table of the pending tasks of a TT, i.e., tasks that are still waiting for inputs.
+     * By default, tasks are kept in PaRSEC hash tables (which grow once their chains become long),
+     * sharded by the hash of the key to reduce contention on the table-wide resize lock.
+     * Optionally, keys can be mapped onto the slots of a directly-indexed table (see set_dense),
+     * which avoids hashing and bucket locks. Keys that are not mapped onto a slot are kept in the hash tables.
+     */
+    template <typename KeyT>
+    class task_table {
+     public:
+      static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+      /* the location of a key in the table */
+      struct ref_t {
+        parsec_key_t hk;
+        std::size_t slot;
+        std::size_t shard;
+      };
+
+      task_table() = default;
+      task_table(const task_table &) = delete;
+      task_table &operator=(const task_table &) = delete;
+
+      /**
+       * Initializes the table to hold about expected_size tasks without resizing,
+       * distributed over num_shards (rounded to a power of two) hash tables.
+       */
+      void init(std::size_t expected_size, std::size_t num_shards, parsec_key_fn_t &key_functions) {
+        m_key_functions = &key_functions;
+        std::size_t shards = 1;
+        while (shards < std::clamp<std::size_t>(num_shards, 1, max_shards)) shards <<= 1;
+        /* aim for chains of about one task */
+        int nb_bits = min_bits;
+        while (nb_bits < max_bits && (std::size_t(1) << nb_bits) * shards < expected_size) ++nb_bits;
+        m_shard_bits = 0;
+        while ((std::size_t(1) << m_shard_bits) < shards) ++m_shard_bits;
+        m_shards = std::vector<shard_t>(shards);
+        for (auto &shard : m_shards) {
+          parsec_hash_table_init(&shard.table, offsetof(parsec_ttg_task_base_t, tt_ht_item), nb_bits, key_functions,
+                                 NULL);
+        }
+        m_nb_bits = nb_bits;
+      }
+
+      void fini() {
+        for (auto &shard : m_shards) {
+          parsec_hash_table_fini(&shard.table);
+        }
+        m_shards.clear();
+        m_slots.reset();
+        m_num_slots = 0;
+      }
+
+      /* re-initializes the hash tables to hold about expected_size tasks, must not be called while tasks are pending */
+      void reserve(std::size_t expected_size) {
+        std::size_t num_shards = m_shards.size();
+        for (auto &shard : m_shards) {
+          parsec_hash_table_fini(&shard.table);
+        }
+        init(expected_size, num_shards, *m_key_functions);
+      }
+
+      task_table_stats_t stats() const {
+        task_table_stats_t stats;
+        stats.num_shards = m_shards.size();
+        stats.num_buckets = m_shards.size() << m_nb_bits;
+        for (auto &shard : m_shards) {
+          stats.inserts += shard.inserts.load(std::memory_order_relaxed);
+          stats.pending += shard.pending.load(std::memory_order_relaxed);
+          stats.max_pending = std::max<std::size_t>(stats.max_pending, shard.max_pending.load(std::memory_order_relaxed));
+          stats.lock_wait_time += shard.lock_wait_ns.load(std::memory_order_relaxed) * 1e-9;
+        }
+        stats.max_pending *= m_shards.size();
+        stats.contended_locks = m_contended.load(std::memory_order_relaxed);
+        return stats;
+      }
+
+      /**
+       * Keep tasks whose keys are mapped onto [0, num_slots) by index in a directly-indexed table.
+       * index should return npos for keys that should be kept in the hash table.
+       * Must not be called while tasks are pending.
+       */
+      template <typename IndexFn>
+      void set_dense(std::size_t num_slots, IndexFn &&index) {
+        m_slots.reset(num_slots > 0 ? new slot_t[num_slots] : nullptr);
+        m_num_slots = num_slots;
+        m_index = std::forward<IndexFn>(index);
+      }
+
+      std::size_t dense_size() const { return m_num_slots; }
+
+      template <typename Key = KeyT>
+      std::enable_if_t<!ttg::meta::is_void_v<Key>, ref_t> ref(const Key &key) const {
+        std::size_t slot = npos;
+        if (m_num_slots > 0) {
+          slot = m_index(key);
+          if (slot >= m_num_slots) slot = npos;
+        }
+        auto hk = reinterpret_cast<parsec_key_t>(&key);
+        std::size_t shard = 0;
+        if (slot == npos && m_shard_bits > 0) {
+          /* the lower bits select the bucket, and PaRSEC uses more of them as the table grows,
+           * so mix the hash and select the shard using the top bits */
+          uint64_t hash = m_key_functions->key_hash(hk, nullptr) * UINT64_C(0x9e3779b97f4a7c15);
+          shard = hash >> (64 - m_shard_bits);
+        }
+        return ref_t{hk, slot, shard};
+      }
+
+      template <typename Key = KeyT>
+      std::enable_if_t<ttg::meta::is_void_v<Key>, ref_t> ref() const {
+        return ref_t{0, npos, 0};
+      }
+
+      void lock(const ref_t &ref) {
+        std::chrono::steady_clock::time_point start;
+        if (task_table_timing) start = std::chrono::steady_clock::now();
+        if (ref.slot != npos) {
+          auto &flag = m_slots[ref.slot].lock;
+          if (flag.test_and_set(std::memory_order_acquire)) {
+            m_contended.fetch_add(1, std::memory_order_relaxed);
+            do {
+              while (flag.test(std::memory_order_relaxed))
+                ; /* spin */
+            } while (flag.test_and_set(std::memory_order_acquire));
+          }
+        } else {
+          parsec_hash_table_lock_bucket(&m_shards[ref.shard].table, ref.hk);
+        }
+        if (task_table_timing) {
+          auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+          m_shards[ref.shard].lock_wait_ns.fetch_add(wait.count(), std::memory_order_relaxed);
+        }
+      }
+
+      void unlock(const ref_t &ref) {
+        if (ref.slot != npos) {
+          m_slots[ref.slot].lock.clear(std::memory_order_release);
+        } else {
+          parsec_hash_table_unlock_bucket(&m_shards[ref.shard].table, ref.hk);
+        }
+      }
+
+      parsec_ttg_task_base_t *nolock_find(const ref_t &ref) {
+        if (ref.slot != npos) {
+          return m_slots[ref.slot].task;
+        }
+        return static_cast<parsec_ttg_task_base_t *>(parsec_hash_table_nolock_find(&m_shards[ref.shard].table, ref.hk));
+      }
+
+      void nolock_insert(const ref_t &ref, parsec_ttg_task_base_t *task) {
+        if (ref.slot != npos) {
+          assert(nullptr == m_slots[ref.slot].task);
+          m_slots[ref.slot].task = task;
+        } else {
+          parsec_hash_table_nolock_insert(&m_shards[ref.shard].table, &task->tt_ht_item);
+        }
+        if (!task_table_timing) return;
+        auto &shard = m_shards[ref.shard];
+        shard.inserts.fetch_add(1, std::memory_order_relaxed);
+        std::size_t pending = shard.pending.fetch_add(1, std::memory_order_relaxed) + 1;
+        std::size_t max_pending = shard.max_pending.load(std::memory_order_relaxed);
+        while (pending > max_pending &&
+               !shard.max_pending.compare_exchange_weak(max_pending, pending, std::memory_order_relaxed))
+          ;
+      }
+
+      void nolock_remove(const ref_t &ref) {
+        if (ref.slot != npos) {
+          m_slots[ref.slot].task = nullptr;
+        } else {
+          parsec_hash_table_nolock_remove(&m_shards[ref.shard].table, ref.hk);
+        }
+        if (task_table_timing) {
+          m_shards[ref.shard].pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+      }
+
+      parsec_ttg_task_base_t *find(const ref_t &ref) {
+        lock(ref);
+        auto *task = nolock_find(ref);
+        unlock(ref);
+        return task;
+      }
+
+      void remove(const ref_t &ref) {
+        lock(ref);
+        nolock_remove(ref);
+        unlock(ref);
+      }
+
+      void insert(const ref_t &ref, parsec_ttg_task_base_t *task) {
+        lock(ref);
+        nolock_insert(ref, task);
+        unlock(ref);
+      }
+
+      /* removes the task of ref from the table and returns it, or nullptr if there is none */
+      parsec_ttg_task_base_t *extract(const ref_t &ref) {
+        lock(ref);
+        auto *task = nolock_find(ref);
+        if (nullptr != task) nolock_remove(ref);
+        unlock(ref);
+        return task;
+      }
+
+      /* invokes fn on all pending tasks, not thread-safe */
+      template <typename Fn>
+      void for_all(Fn &&fn) {
+        for (std::size_t i = 0; i < m_num_slots; ++i) {
+          if (nullptr != m_slots[i].task) fn(m_slots[i].task);
+        }
+        for (auto &shard : m_shards) {
+          parsec_hash_table_for_all(
+              &shard.table, [](void *item, void *cb_data) {
+                (*static_cast<std::remove_reference_t<Fn> *>(cb_data))(static_cast<parsec_ttg_task_base_t *>(item));
+              },
+              &fn);
+        }
+      }
+
+     private:
+      static constexpr int min_bits = 8;
+      static constexpr int max_bits = 24;
+      static constexpr std::size_t max_shards = 64;
+
+      /* a hash table and its statistics, aligned to avoid false sharing between shards */
+      struct alignas(64) shard_t {
+        parsec_hash_table_t table;
+        std::atomic<std::size_t> inserts = 0;
+        std::atomic<std::size_t> pending = 0;
+        std::atomic<std::size_t> max_pending = 0;
+        std::atomic<std::uint64_t> lock_wait_ns = 0;
+      };
+
+      struct slot_t {
+        parsec_ttg_task_base_t *task = nullptr;  //< protected by lock
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+      };
+
+      std::vector<shard_t> m_shards;
+      parsec_key_fn_t *m_key_functions = nullptr;
+      int m_nb_bits = min_bits;
+      int m_shard_bits = 0;
+      std::atomic<std::size_t> m_contended = 0;
+      std::unique_ptr<slot_t[]> m_slots;
+      std::size_t m_num_slots = 0;
+      std::function<std::size_t(const std::conditional_t<ttg::meta::is_void_v<KeyT>, int, KeyT> &)> m_index;
+    };
+
+  }  // namespace detail
+
+}  // namespace ttg_parsec
+
+#endif  // TTG_PARSEC_TASK_TABLE_H
@@ -52,7 +52,9 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <experimental/type_traits>
 #include <functional>
@@ -63,9 +65,12 @@
 #include <memory>
 #include <mutex>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 // needed for MPIX_CUDA_AWARE_SUPPORT
@@ -118,6 +123,7 @@
 #include "ttg/parsec/thread_local.h"
 #include "ttg/parsec/ptr.h"
 #include "ttg/parsec/task.h"
+#include "ttg/parsec/task_table.h"
 #include "ttg/parsec/parsec-ext.h"
 
 #include "ttg/device/device.h"
@@ -133,10 +139,7 @@ int parsec_add_fetch_runtime_task(parsec_taskpool_t *tp, int tasks);
 namespace ttg_parsec {
   typedef void (*static_set_arg_fct_type)(void *, size_t, ttg::TTBase *);
   typedef std::pair<static_set_arg_fct_type, ttg::TTBase *> static_set_arg_fct_call_t;
-  inline std::map<uint64_t, static_set_arg_fct_call_t> static_id_to_op_map;
-  inline std::mutex static_map_mutex;
   typedef std::tuple<int, void *, size_t> static_set_arg_fct_arg_t;
-  inline std::multimap<uint64_t, static_set_arg_fct_arg_t> delayed_unpack_actions;
 
   struct msg_header_t {
     typedef enum fn_id : std::int8_t {
@@ -144,13 +147,15 @@ namespace ttg_parsec {
       MSG_SET_ARG = 0,
       MSG_SET_ARGSTREAM_SIZE = 1,
       MSG_FINALIZE_ARGSTREAM_SIZE = 2,
-      MSG_GET_FROM_PULL = 3 } fn_id_t;
+      MSG_GET_FROM_PULL = 3,
+      MSG_AGGREGATE = 4 } fn_id_t;
     uint32_t taskpool_id = std::numeric_limits<uint32_t>::max();
     uint64_t op_id = std::numeric_limits<uint64_t>::max();
     std::size_t key_offset = 0;
     fn_id_t fn_id = MSG_INVALID;
     std::int8_t num_iovecs = 0;
     bool inline_data = false;
+    bool rendezvous = false;
     int32_t param_id = -1;
     int num_keys = 0;
     int sender = -1;
@@ -191,33 +196,429 @@ namespace ttg_parsec {
 
     inline std::size_t max_inline_size = msg_t::max_payload_size;
 
+    /* serialized values larger than this are transferred through a staging buffer (see TTG_RENDEZVOUS_SIZE),
+     * leaving room in the message for the keys */
+    inline std::size_t rendezvous_size = msg_t::max_payload_size / 2;
+
+    /**
+     * Per-thread pool of active message buffers, organized in power-of-two size classes
+     * ranging from 256B to PARSEC_TTG_MAX_AM_SIZE. Messages are packed directly into
+     * a buffer of the smallest class that fits and the buffer is returned to the pool
+     * of the releasing thread once send_am has returned.
+     */
+    struct msg_pool {
+      static constexpr int min_class_bits = 8;
+      static constexpr int max_class_bits = 20;
+      static constexpr int num_classes = max_class_bits - min_class_bits + 1;
+      /* number of buffers kept per class and thread, excess buffers are freed */
+      static constexpr std::size_t max_cached = 16;
+      static_assert((std::size_t{1} << max_class_bits) == PARSEC_TTG_MAX_AM_SIZE,
+                    "Largest message size class must match PARSEC_TTG_MAX_AM_SIZE");
+
+      struct stats_t {
+        std::atomic<std::size_t> hits = 0;
+        std::atomic<std::size_t> misses = 0;
+        std::atomic<std::size_t> bytes_in_flight = 0;
+      };
+
+      static stats_t& stats() {
+        static stats_t s;
+        return s;
+      }
+
+      static constexpr std::size_t class_size(int size_class) {
+        return std::size_t{1} << (size_class + min_class_bits);
+      }
+
+      static int size_class(std::size_t size) {
+        int c = 0;
+        while (c < num_classes-1 && class_size(c) < size) ++c;
+        return c;
+      }
+
+      /* release a buffer of the given size class back to the calling thread's pool */
+      static void release(void *buf, int size_class) {
+        stats().bytes_in_flight.fetch_sub(class_size(size_class), std::memory_order_relaxed);
+        auto& fl = freelists()[size_class];
+        if (fl.size() < max_cached) {
+          fl.push_back(buf);
+        } else {
+          ::operator delete(buf);
+        }
+      }
+
+      /* acquire a buffer able to hold at least size bytes */
+      static std::pair<void*, int> acquire(std::size_t size) {
+        assert(size <= PARSEC_TTG_MAX_AM_SIZE);
+        int c = size_class(size);
+        auto& fl = freelists()[c];
+        void *buf;
+        if (!fl.empty()) {
+          buf = fl.back();
+          fl.pop_back();
+          stats().hits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+          buf = ::operator new(class_size(c));
+          stats().misses.fetch_add(1, std::memory_order_relaxed);
+        }
+        stats().bytes_in_flight.fetch_add(class_size(c), std::memory_order_relaxed);
+        return {buf, c};
+      }
+
+     private:
+      struct freelists_t : std::array<std::vector<void*>, num_classes> {
+        ~freelists_t() {
+          for (auto& fl : *this) {
+            for (void *buf : fl) ::operator delete(buf);
+          }
+        }
+      };
+
+      static freelists_t& freelists() {
+        static thread_local freelists_t fl;
+        return fl;
+      }
+    };
+
+    /* returns a message buffer to the msg_pool */
+    struct msg_release_t {
+      int size_class = msg_pool::num_classes - 1;
+      void operator()(msg_t *msg) const {
+        msg->tt_id.~msg_header_t();
+        msg_pool::release(msg, size_class);
+      }
+    };
+
+    using msg_ptr_t = std::unique_ptr<msg_t, msg_release_t>;
+
+    /**
+     * Allocate a message from the msg_pool that can hold payload_size bytes after the header.
+     * Only the header is constructed, \c bytes is valid up to the requested payload size,
+     * which mirrors how received messages are accessed in static_unpack_msg.
+     */
+    inline msg_ptr_t make_msg(std::size_t payload_size,
+                              uint64_t tt_id,
+                              uint32_t taskpool_id,
+                              msg_header_t::fn_id_t fn_id,
+                              int32_t param_id,
+                              int sender,
+                              int num_keys = 1) {
+      auto [buf, size_class] = msg_pool::acquire(sizeof(msg_header_t) + payload_size);
+      static_assert(offsetof(msg_t, bytes) == sizeof(msg_header_t));
+      msg_t *msg = reinterpret_cast<msg_t*>(buf);
+      new (&msg->tt_id) msg_header_t(fn_id, taskpool_id, tt_id, param_id, sender, num_keys);
+      return msg_ptr_t(msg, msg_release_t{size_class});
+    }
+
+    /* messages of at least this size carrying inline data are unpacked by a worker thread
+     * instead of the communication thread (see TTG_UNPACK_OFFLOAD_SIZE), disabled by default.
+     * Messages to streaming terminals are always unpacked in order of arrival on the communication thread. */
+    inline std::size_t unpack_offload_size = std::numeric_limits<std::size_t>::max();
+
+    /* whether fences start the next epoch on the same taskpool instead of recreating it (see TTG_REUSE_TASKPOOL),
+     * disabled by default until PaRSEC supports epochs in taskpools (see Issue #118 (TTG)) */
+    inline bool reuse_taskpool = false;
+
+    /* maximum number of tasks executed inline on top of each other (see TTG_MAX_INLINE_DEPTH), 0 disables inlining */
+    inline int max_inline_depth = 6;
+
+    /* set while the body of a task runs on this thread, only then ready tasks are held for inlining */
+    inline thread_local bool inline_window = false;
+
+    /* the ready task held for execution once the running task completes */
+    inline thread_local parsec_task_t *inline_task = nullptr;
+
+    /* the number of inlined tasks currently executing on this thread */
+    inline thread_local int inline_depth = 0;
+
+    /* tasks made ready by the body of the running task, released in one batch sorted by priority once the body returns */
+    inline thread_local std::vector<parsec_task_t *> ready_tasks;
+
+    /* the first of the ready_tasks that belongs to the running task, earlier ones belong to the tasks it was inlined into */
+    inline thread_local std::size_t ready_begin = 0;
+
+    inline void push_ready_task(parsec_task_t *task) {
+      ready_tasks.push_back(task);
+    }
+
+    /* hands the tasks made ready by the running task over to the scheduler, in a ring sorted by priority */
+    inline void schedule_ready_tasks(parsec_execution_stream_t *es) {
+      if (ready_tasks.size() == ready_begin) return;
+      auto begin = ready_tasks.begin() + ready_begin;
+      /* sort once instead of inserting each task into a sorted ring, highest priority first */
+      std::stable_sort(begin, ready_tasks.end(),
+                       [](const parsec_task_t *a, const parsec_task_t *b) { return a->priority > b->priority; });
+      parsec_task_t *ring = *begin;
+      for (auto it = begin + 1; it != ready_tasks.end(); ++it) {
+        parsec_list_item_ring_push(&ring->super, &(*it)->super);
+      }
+      ready_tasks.resize(ready_begin);
+      parsec_task_t *vp_task_ring[1] = { ring };
+      __parsec_schedule_vp(es, vp_task_ring, 0);
+    }
+
+    /* hands the held task, if any, over to the scheduler */
+    inline void schedule_inline_task(parsec_execution_stream_t *es) {
+      parsec_task_t *task = inline_task;
+      if (nullptr != task) {
+        inline_task = nullptr;
+        parsec_task_t *vp_task_ring[1] = { task };
+        __parsec_schedule_vp(es, vp_task_ring, 0);
+      }
+    }
+
+    /* executes the held task, if any, in the execution stream of the task that just completed */
+    inline void execute_inline_task(parsec_execution_stream_t *es) {
+      parsec_task_t *task = inline_task;
+      if (nullptr != task) {
+        inline_task = nullptr;
+        ++inline_depth;
+        __parsec_task_progress(es, task, 0);
+        --inline_depth;
+      }
+    }
+
+    /* maximum payload of a message of coalesced set_arg messages, see msg_aggregator */
+    inline std::size_t max_aggregation_size = 16*1024;
+
+    /**
+     * Coalesces small messages sent from within a task body to the same TT, input terminal
+     * and destination into a single MSG_AGGREGATE active message, in which each original
+     * message is stored as [uint64_t size, message (padded to 8B)].
+     * Aggregation buffers are taken from the msg_pool of the sending thread, flushed once they
+     * reach max_aggregation_size, and flushed and returned to the msg_pool when the task that
+     * filled them completes, so a thread only holds buffers for the destinations of its running task.
+     */
+    struct msg_aggregator {
+
+      static constexpr std::size_t align(std::size_t size) {
+        return (size + alignof(msg_header_t) - 1) & ~(alignof(msg_header_t) - 1);
+      }
+
+      /* append a packed message of msg_size bytes (including the header) to the buffer for dest.
+       * Returns false if the message is too large to be coalesced and has to be sent directly. */
+      static bool append(int dest, const msg_t *msg, std::size_t msg_size,
+                         parsec_taskpool_t *tp, parsec_ce_tag_t tag) {
+        std::size_t record_size = sizeof(uint64_t) + align(msg_size);
+        if (record_size > max_aggregation_size) return false;
+        auto& st = state();
+        key_t key{msg->tt_id.op_id, msg->tt_id.param_id, dest};
+        auto& buf = st.buffers[key];
+        if (nullptr == buf.msg) {
+          buf.msg = make_msg(max_aggregation_size, msg->tt_id.op_id, tp->taskpool_id, msg_header_t::MSG_AGGREGATE,
+                             msg->tt_id.param_id, msg->tt_id.sender, 0);
+        }
+        if (buf.pos + record_size > max_aggregation_size) {
+          flush(dest, buf);
+        }
+        buf.tp = tp;
+        buf.tag = tag;
+        uint64_t size = msg_size;
+        std::memcpy(buf.msg->bytes + buf.pos, &size, sizeof(size));
+        std::memcpy(buf.msg->bytes + buf.pos + sizeof(size), msg, msg_size);
+        buf.pos += record_size;
+        buf.msg->tt_id.num_keys++;
+        return true;
+      }
+
+      /* send the messages coalesced by the calling thread for the given TT, input terminal and destination,
+       * used to keep stream-control messages from overtaking the contributions they refer to */
+      static void flush(int dest, uint64_t op_id, int32_t param_id) {
+        auto& st = state();
+        auto it = st.buffers.find(key_t{op_id, param_id, dest});
+        if (it != st.buffers.end()) {
+          /* the buffer is kept until flush_all, flushing an empty buffer is a no-op */
+          flush(dest, it->second);
+        }
+      }
+
+      /* send all messages coalesced by the calling thread and return their buffers to the msg_pool */
+      static void flush_all() {
+        auto& st = state();
+        if (st.buffers.empty()) return;
+        for (auto& [key, buf] : st.buffers) {
+          flush(std::get<2>(key), buf);
+        }
+        st.buffers.clear();
+      }
+
+     private:
+      struct buffer_t {
+        msg_ptr_t msg;
+        std::size_t pos = 0;
+        parsec_taskpool_t *tp = nullptr;
+        parsec_ce_tag_t tag = 0;
+      };
+
+      using key_t = std::tuple<uint64_t, int32_t, int>;
+
+      struct key_hash_t {
+        std::size_t operator()(const key_t& key) const {
+          auto [op_id, param_id, dest] = key;
+          std::size_t h = std::hash<uint64_t>{}(op_id);
+          h ^= std::hash<uint64_t>{}((static_cast<uint64_t>(param_id) << 32) | static_cast<uint32_t>(dest)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+          return h;
+        }
+      };
+
+      struct state_t {
+        /* the buffers filled by the running task */
+        std::unordered_map<key_t, buffer_t, key_hash_t> buffers;
+      };
+
+      static state_t& state() {
+        static thread_local state_t st;
+        return st;
+      }
+
+      static void flush(int dest, buffer_t& buf) {
+        if (0 == buf.msg->tt_id.num_keys) return;
+        parsec_taskpool_t *tp = buf.tp;
+        buf.msg->tt_id.taskpool_id = tp->taskpool_id;
+        tp->tdm.module->outgoing_message_start(tp, dest, NULL);
+        tp->tdm.module->outgoing_message_pack(tp, dest, NULL, NULL, 0);
+        parsec_ce.send_am(&parsec_ce, buf.tag, dest, static_cast<void *>(buf.msg.get()),
+                          sizeof(msg_header_t) + buf.pos);
+        buf.pos = 0;
+        buf.msg->tt_id.num_keys = 0;
+      }
+    };
+
+    /**
+     * Registry of the TTs that receive active messages, indexed by instance id.
+     * Lookups on the receive path are lock-free: entries are stored in chunks that are
+     * allocated on demand and a TT becomes visible through a release-store of its pointer
+     * once the unpack function has been set. Messages for TTs that are not yet registered
+     * are delayed; the mutex only serializes registration with delaying messages so that
+     * no delayed message is missed by the registering thread. Instance ids beyond the chunks
+     * (i.e., in long runs creating many TTs) are kept in a map protected by the mutex.
+     */
+    class op_registry {
+     public:
+      static op_registry& instance() {
+        static op_registry registry;
+        return registry;
+      }
+
+      ~op_registry() {
+        for (auto& chunk : m_chunks) {
+          delete[] chunk.load(std::memory_order_relaxed);
+        }
+        for (auto& [op_id, args] : m_delayed) {
+          free(std::get<1>(args));
+        }
+      }
+
+      /* lock-free lookup, returns {nullptr, nullptr} if the op is not registered */
+      static_set_arg_fct_call_t find(uint64_t op_id) const {
+        std::size_t c = op_id / chunk_size;
+        if (c >= max_chunks) {
+          std::lock_guard<std::mutex> lock(m_mtx);
+          return find_overflow(op_id);
+        }
+        entry_t *chunk = m_chunks[c].load(std::memory_order_acquire);
+        if (nullptr == chunk) return {nullptr, nullptr};
+        entry_t& entry = chunk[op_id % chunk_size];
+        ttg::TTBase *op = entry.op.load(std::memory_order_acquire);
+        if (nullptr == op) return {nullptr, nullptr};
+        return {entry.fn, op};
+      }
+
+      /* publish the op and return the messages that were delayed for it */
+      std::vector<static_set_arg_fct_arg_t> insert(uint64_t op_id, static_set_arg_fct_call_t call) {
+        std::size_t c = op_id / chunk_size;
+        std::vector<static_set_arg_fct_arg_t> delayed;
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (c >= max_chunks) {
+          m_overflow[op_id] = call;
+        } else {
+          entry_t *chunk = m_chunks[c].load(std::memory_order_relaxed);
+          if (nullptr == chunk) {
+            chunk = new entry_t[chunk_size];
+            m_chunks[c].store(chunk, std::memory_order_release);
+          }
+          entry_t& entry = chunk[op_id % chunk_size];
+          entry.fn = call.first;
+          entry.op.store(call.second, std::memory_order_release);
+        }
+        auto se = m_delayed.equal_range(op_id);
+        for (auto it = se.first; it != se.second; ++it) {
+          delayed.push_back(it->second);
+        }
+        m_delayed.erase(se.first, se.second);
+        return delayed;
+      }
+
+      void remove(uint64_t op_id) {
+        std::size_t c = op_id / chunk_size;
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (c >= max_chunks) {
+          m_overflow.erase(op_id);
+          return;
+        }
+        entry_t *chunk = m_chunks[c].load(std::memory_order_relaxed);
+        if (nullptr != chunk) {
+          chunk[op_id % chunk_size].op.store(nullptr, std::memory_order_release);
+        }
+      }
+
+      /* delay a message for an op that is not yet registered,
+       * returns the op if it was registered concurrently */
+      static_set_arg_fct_call_t delay(uint64_t op_id, int src_rank, void *data, std::size_t size) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto call = (op_id / chunk_size < max_chunks) ? find(op_id) : find_overflow(op_id);
+        if (nullptr == call.second) {
+          void *data_cpy = malloc(size);
+          assert(data_cpy != 0);
+          memcpy(data_cpy, data, size);
+          ttg::trace("ttg_parsec(", ttg_default_execution_context().rank(), ") Delaying delivery of message (", src_rank,
+                     ", ", op_id, ", ", data_cpy, ", ", size, ")");
+          m_delayed.insert(std::make_pair(op_id, std::make_tuple(src_rank, data_cpy, size)));
+        }
+        return call;
+      }
+
+     private:
+      static constexpr std::size_t chunk_size = 1024;
+      static constexpr std::size_t max_chunks = 1024;
+
+      struct entry_t {
+        static_set_arg_fct_type fn = nullptr;
+        std::atomic<ttg::TTBase *> op = nullptr;
+      };
+
+      /* must be called with the mutex held */
+      static_set_arg_fct_call_t find_overflow(uint64_t op_id) const {
+        auto it = m_overflow.find(op_id);
+        if (it == m_overflow.end()) return {nullptr, nullptr};
+        return it->second;
+      }
+
+      std::array<std::atomic<entry_t *>, max_chunks> m_chunks = {};
+      mutable std::mutex m_mtx;
+      std::multimap<uint64_t, static_set_arg_fct_arg_t> m_delayed;
+      std::unordered_map<uint64_t, static_set_arg_fct_call_t> m_overflow; //< ops with ids beyond the chunks
+    };
+
     static int static_unpack_msg(parsec_comm_engine_t *ce, uint64_t tag, void *data, long unsigned int size,
                                  int src_rank, void *obj) {
-      static_set_arg_fct_type static_set_arg_fct;
       parsec_taskpool_t *tp = NULL;
       msg_header_t *msg = static_cast<msg_header_t *>(data);
       uint64_t op_id = msg->op_id;
       tp = parsec_taskpool_lookup(msg->taskpool_id);
       assert(NULL != tp);
-      static_map_mutex.lock();
-      try {
-        auto op_pair = static_id_to_op_map.at(op_id);
-        static_map_mutex.unlock();
-        tp->tdm.module->incoming_message_start(tp, src_rank, NULL, NULL, 0, NULL);
-        static_set_arg_fct = op_pair.first;
-        static_set_arg_fct(data, size, op_pair.second);
-        tp->tdm.module->incoming_message_end(tp, NULL);
-        return 0;
-      } catch (const std::out_of_range &e) {
-        void *data_cpy = malloc(size);
-        assert(data_cpy != 0);
-        memcpy(data_cpy, data, size);
-        ttg::trace("ttg_parsec(", ttg_default_execution_context().rank(), ") Delaying delivery of message (", src_rank,
-                   ", ", op_id, ", ", data_cpy, ", ", size, ")");
-        delayed_unpack_actions.insert(std::make_pair(op_id, std::make_tuple(src_rank, data_cpy, size)));
-        static_map_mutex.unlock();
-        return 1;
+      auto& registry = op_registry::instance();
+      auto op_pair = registry.find(op_id);
+      if (nullptr == op_pair.second) {
+        op_pair = registry.delay(op_id, src_rank, data, size);
+        if (nullptr == op_pair.second) {
+          return 1;
+        }
       }
+      tp->tdm.module->incoming_message_start(tp, src_rank, NULL, NULL, 0, NULL);
+      op_pair.first(data, size, op_pair.second);
+      tp->tdm.module->incoming_message_end(tp, NULL);
+      return 0;
     }
 
     static int get_remote_complete_cb(parsec_comm_engine_t *ce, parsec_ce_tag_t tag, void *msg, size_t msg_size,
@@ -230,8 +631,55 @@ namespace ttg_parsec {
 
     inline bool all_devices_peer_access;
 
+    /* task unpacking a copy of an incoming active message on a worker thread */
+    struct unpack_task_t : public parsec_ttg_task_base_t {
+      ttg::TTBase *op;
+      void *data;
+      std::size_t size;
+
+      unpack_task_t(parsec_thread_mempool_t *mempool, parsec_task_class_t *task_class,
+                    parsec_taskpool_t *taskpool, ttg::TTBase *op, void *data, std::size_t size)
+      : parsec_ttg_task_base_t(mempool, task_class, taskpool, 0, 0, nullptr, nullptr)
+      , op(op)
+      , data(data)
+      , size(size)
+      { }
+    };
+
   }  // namespace detail
 
+  using memreg_cache_stats_t = detail::memreg_cache::stats_t;
+
+  using task_table_stats_t = detail::task_table_stats_t;
+
+  /// \return a snapshot of the statistics of the memory registration cache used for RMA transfers
+  inline memreg_cache_stats_t memreg_cache_stats() {
+    return detail::memreg_cache::instance().stats();
+  }
+
+  /// statistics of the per-thread active message buffer pools
+  struct msg_pool_stats_t {
+    std::size_t hits;             //!< number of messages packed into a recycled buffer
+    std::size_t misses;           //!< number of messages that required a new buffer
+    std::size_t bytes_in_flight;  //!< number of buffer bytes held by messages currently being sent
+  };
+
+  /// \return a snapshot of the statistics of the active message buffer pools, aggregated over all threads
+  inline msg_pool_stats_t msg_pool_stats() {
+    auto& stats = detail::msg_pool::stats();
+    return msg_pool_stats_t{stats.hits.load(std::memory_order_relaxed),
+                            stats.misses.load(std::memory_order_relaxed),
+                            stats.bytes_in_flight.load(std::memory_order_relaxed)};
+  }
+
+  /// statistics of the fences of a World, see WorldImpl::fence_stats()
+  struct fence_stats_t {
+    std::size_t num_fences = 0;       //!< number of fences that completed an epoch
+    double wait_time = 0.0;           //!< seconds spent waiting for the completion of epochs
+    double overhead_time = 0.0;       //!< seconds spent synchronizing and preparing the next epoch
+    double last_overhead_time = 0.0;  //!< overhead of the most recent fence, in seconds
+  };
+
   class WorldImpl : public ttg::base::WorldImplBase {
     ttg::Edge<> m_ctl_edge;
     bool _dag_profiling;
@@ -382,7 +830,7 @@ namespace ttg_parsec {
       // taskpool enabling, to avoid a race condition that would keep
       // termination detection-related messages in a waiting queue
       // forever
-      MPI_Barrier(comm());
+      if (size() > 1) MPI_Barrier(comm());
 
       parsec_taskpool_started = false;
     }
@@ -417,6 +865,26 @@ namespace ttg_parsec {
       }
     }
 
+    /* re-arms the termination detection of the taskpool for the next epoch if detail::reuse_taskpool is set, see fence_impl */
+    void reset_tpool() {
+      assert(NULL != tpool->tdm.monitor);
+      tpool->tdm.module->unmonitor_taskpool(tpool);
+      tpool->tdm.module->monitor_taskpool(tpool, parsec_taskpool_termination_detected);
+      tpool->tdm.module->taskpool_set_nb_tasks(tpool, 0);
+      tpool->tdm.module->taskpool_set_runtime_actions(tpool, 0);
+      tpool->on_complete = nullptr;
+      tpool->on_complete_data = nullptr;
+      parsec_taskpool_started = false;
+      async_fence_pending = false;
+      ++epoch_id;
+    }
+
+    /* invoked by PaRSEC once the termination of an epoch completed by fence_async was detected */
+    static int epoch_complete_cb(parsec_taskpool_t *tp, void *cb_data) {
+      static_cast<WorldImpl *>(cb_data)->trigger_statuses();
+      return PARSEC_SUCCESS;
+    }
+
     void destroy_tpool() {
 #if defined(PARSEC_PROF_TRACE)
       // We don't want to release the profiling array, as it should be persistent
@@ -433,8 +901,8 @@ namespace ttg_parsec {
     virtual void destroy() override {
       if (is_valid()) {
         if (parsec_taskpool_started) {
-          // We are locally ready (i.e. we won't add new tasks)
-          tpool->tdm.module->taskpool_addto_runtime_actions(tpool, -1);
+          // We are locally ready (i.e. we won't add new tasks), unless fence_async already said so
+          if (!async_fence_pending) tpool->tdm.module->taskpool_addto_runtime_actions(tpool, -1);
           ttg::trace("ttg_parsec(", this->rank(), "): final waiting for completion");
           if (own_ctx)
             parsec_context_wait(ctx);
@@ -565,27 +1033,71 @@ namespace ttg_parsec {
     }
 #endif
 
+    /// \return the statistics of the fences of this world
+    const fence_stats_t &fence_stats() const { return m_fence_stats; }
+
+    /// \return the number of epochs completed by fences
+    std::size_t epoch() const { return epoch_id; }
+
     virtual void fence_impl(void) override {
       int rank = this->rank();
       if (!parsec_taskpool_started) {
         ttg::trace("ttg_parsec::(", rank, "): parsec taskpool has not been started, fence is a simple MPI_Barrier");
-        MPI_Barrier(comm());
+        if (size() > 1) MPI_Barrier(comm());
         return;
       }
       ttg::trace("ttg_parsec::(", rank, "): parsec taskpool is ready for completion");
-      // We are locally ready (i.e. we won't add new tasks)
-      tpool->tdm.module->taskpool_addto_runtime_actions(tpool, -1);
+      auto start = std::chrono::steady_clock::now();
+      // We are locally ready (i.e. we won't add new tasks), unless fence_async already said so
+      if (!async_fence_pending) tpool->tdm.module->taskpool_addto_runtime_actions(tpool, -1);
       ttg::trace("ttg_parsec(", rank, "): waiting for completion");
       parsec_taskpool_wait(tpool);
+      auto done = std::chrono::steady_clock::now();
+
+      if (detail::reuse_taskpool) {
+        /* Start a new epoch on the same taskpool instead of recreating it, which would require
+         * reserving a new taskpool ID and setting up a new termination detection.
+         * The termination detection of all processes has to be re-armed before any process
+         * starts sending messages of the new epoch (see Issue #118 (TTG)). */
+        reset_tpool();
+        if (size() > 1) MPI_Barrier(comm());
+      } else {
+        // We need the synchronization between the end of the context and the restart of the taskpool
+        // until we use parsec_taskpool_wait and implement an epoch in the PaRSEC taskpool
+        // see Issue #118 (TTG)
+        if (size() > 1) MPI_Barrier(comm());
 
-      // We need the synchronization between the end of the context and the restart of the taskpool
-      // until we use parsec_taskpool_wait and implement an epoch in the PaRSEC taskpool
-      // see Issue #118 (TTG)
-      MPI_Barrier(comm());
-
-      destroy_tpool();
-      create_tpool();
+        destroy_tpool();
+        create_tpool();
+        async_fence_pending = false;
+        ++epoch_id;
+      }
       execute();
+
+      auto end = std::chrono::steady_clock::now();
+      double overhead = std::chrono::duration<double>(end - done).count();
+      m_fence_stats.num_fences++;
+      m_fence_stats.wait_time += std::chrono::duration<double>(done - start).count();
+      m_fence_stats.overhead_time += overhead;
+      m_fence_stats.last_overhead_time = overhead;
+      ttg::trace("ttg_parsec(", rank, "): completed epoch ", epoch_id - 1, ", fence overhead ", overhead, "s");
+    }
+
+    virtual void fence_async_impl(void) override {
+      if (!parsec_taskpool_started || async_fence_pending) {
+        /* nothing to wait for or the completion is already pending */
+        if (!async_fence_pending) {
+          if (size() > 1) MPI_Barrier(comm());
+          trigger_statuses();
+        }
+        return;
+      }
+      ttg::trace("ttg_parsec::(", this->rank(), "): parsec taskpool is ready for asynchronous completion");
+      async_fence_pending = true;
+      tpool->on_complete = &epoch_complete_cb;
+      tpool->on_complete_data = this;
+      // We are locally ready (i.e. we won't add new tasks)
+      tpool->tdm.module->taskpool_addto_runtime_actions(tpool, -1);
     }
 
    private:
@@ -593,6 +1105,9 @@ namespace ttg_parsec {
     bool own_ctx = false;  //< whether I own the context
     parsec_taskpool_t *tpool = nullptr;
     bool parsec_taskpool_started = false;
+    bool async_fence_pending = false;  //< whether fence_async marked the current epoch as complete
+    std::size_t epoch_id = 0;
+    fence_stats_t m_fence_stats;
 #if defined(PARSEC_PROF_TRACE)
     int        *profiling_array;
     std::size_t profiling_array_size;
@@ -857,10 +1372,18 @@ namespace ttg_parsec {
       std::atomic<int> _outstanding_transfers;
       ActivationCallbackT _cb;
       detail::ttg_data_copy_t *_copy;
+      std::vector<memreg_cache::handle_t> _memregs;
 
      public:
       rma_delayed_activate(std::vector<KeyT> &&key, detail::ttg_data_copy_t *copy, int num_transfers, ActivationCallbackT cb)
-          : _keylist(std::move(key)), _outstanding_transfers(num_transfers), _cb(cb), _copy(copy) {}
+          : _keylist(std::move(key)), _outstanding_transfers(num_transfers), _cb(cb), _copy(copy) {
+        _memregs.reserve(num_transfers);
+      }
+
+      /* keep the local registration alive until all transfers have completed */
+      void add_memreg(memreg_cache::handle_t memreg) {
+        _memregs.push_back(std::move(memreg));
+      }
 
       bool complete_transfer(void) {
         int left = --_outstanding_transfers;
@@ -872,11 +1395,19 @@ namespace ttg_parsec {
       }
     };
 
+    /* registered staging buffer holding a serialized value that is read by the receiver through RMA */
+    struct rendezvous_buffer_t {
+      std::unique_ptr<unsigned char[]> data;
+      uint64_t size = 0;
+      memreg_cache::handle_t memreg;
+      int32_t memreg_size = 0;
+    };
+
     template <typename ActivationT>
     static int get_complete_cb(parsec_comm_engine_t *comm_engine, parsec_ce_mem_reg_handle_t lreg, ptrdiff_t ldispl,
                                parsec_ce_mem_reg_handle_t rreg, ptrdiff_t rdispl, size_t size, int remote,
                                void *cb_data) {
-      parsec_ce.mem_unregister(&lreg);
+      /* the local registration is released together with the activation */
       ActivationT *activation = static_cast<ActivationT *>(cb_data);
       if (activation->complete_transfer()) {
         delete activation;
@@ -1102,6 +1633,52 @@ namespace ttg_parsec {
       }
     }
 
+    /* parse the size beyond which serialized values are transferred through a staging buffer */
+    const char* ttg_rendezvous_cstr = std::getenv("TTG_RENDEZVOUS_SIZE");
+    if (nullptr != ttg_rendezvous_cstr) {
+      std::size_t rendezvous_size = std::atol(ttg_rendezvous_cstr);
+      if (rendezvous_size < detail::rendezvous_size) {
+        detail::rendezvous_size = rendezvous_size;
+      }
+    }
+
+    /* parse the maximum number of bytes kept registered for RMA transfers */
+    const char* ttg_memreg_cache_cstr = std::getenv("TTG_MEMREG_CACHE_SIZE");
+    if (nullptr != ttg_memreg_cache_cstr) {
+      detail::memreg_cache::instance().set_capacity(std::atol(ttg_memreg_cache_cstr));
+    }
+
+    /* measure and report the contention on the tables of pending tasks */
+    if (nullptr != std::getenv("TTG_TASK_TABLE_STATS")) {
+      detail::task_table_timing = true;
+    }
+
+    /* reuse the taskpool across fences */
+    if (nullptr != std::getenv("TTG_REUSE_TASKPOOL")) {
+      detail::reuse_taskpool = true;
+    }
+
+    /* parse the maximum depth of inlined successor tasks */
+    const char* ttg_max_inline_depth_cstr = std::getenv("TTG_MAX_INLINE_DEPTH");
+    if (nullptr != ttg_max_inline_depth_cstr) {
+      detail::max_inline_depth = std::atoi(ttg_max_inline_depth_cstr);
+    }
+
+    /* parse the minimum size of messages unpacked by worker threads */
+    const char* ttg_unpack_offload_cstr = std::getenv("TTG_UNPACK_OFFLOAD_SIZE");
+    if (nullptr != ttg_unpack_offload_cstr) {
+      detail::unpack_offload_size = std::atol(ttg_unpack_offload_cstr);
+    }
+
+    /* parse the maximum size of coalesced messages */
+    const char* ttg_max_aggregation_cstr = std::getenv("TTG_MAX_AGGREGATION_SIZE");
+    if (nullptr != ttg_max_aggregation_cstr) {
+      std::size_t aggregation_size = std::atol(ttg_max_aggregation_cstr);
+      if (aggregation_size < detail::msg_t::max_payload_size) {
+        detail::max_aggregation_size = aggregation_size;
+      }
+    }
+
     bool all_peer_access = true;
     /* check whether all GPUs can access all peer GPUs */
     for (int i = 0; (i < parsec_nb_devices) && all_peer_access; ++i) {
@@ -1127,6 +1704,8 @@ namespace ttg_parsec {
       ttg::default_execution_context().impl().final_task();
     ttg::detail::set_default_world(ttg::World{});  // reset the default world
     detail::ptr_impl::drop_all_ptr();
+    /* cached registrations are unregistered with the comm engine, which is shut down with the worlds */
+    detail::memreg_cache::instance().clear();
     ttg::detail::destroy_worlds<ttg_parsec::WorldImpl>();
     if (detail::initialized_mpi()) MPI_Finalize();
   }
@@ -1136,6 +1715,8 @@ namespace ttg_parsec {
   inline void ttg_execute(ttg::World world) { world.impl().execute(); }
   inline void ttg_fence(ttg::World world) { world.impl().fence(); }
 
+  inline std::future<void> ttg_fence_async(ttg::World world) { return world.impl().fence_async(); }
+
   template <typename T>
   inline void ttg_register_ptr(ttg::World world, const std::shared_ptr<T> &ptr) {
     world.impl().register_ptr(ptr);
@@ -1193,9 +1774,9 @@ namespace ttg_parsec {
     struct ParsecTTBase {
      protected:
       //  static std::map<int, ParsecBaseTT*> function_id_to_instance;
-      parsec_hash_table_t tasks_table;
-      parsec_hash_table_t task_constraint_table;
       parsec_task_class_t self;
+      parsec_task_class_t unpack_taskclass;   //< task class of tasks unpacking incoming messages
+      __parsec_chore_t unpack_chores[2];
     };
 
   }  // namespace detail
@@ -1362,6 +1943,20 @@ namespace ttg_parsec {
 
     bool m_defer_writer = TTG_PARSEC_DEFER_WRITER;
 
+    bool m_inline = false;  //< whether tasks of this TT may be executed inline by the task that made them ready
+
+    std::array<bool, numins> m_aggregate_input = { false };
+
+    std::array<std::size_t, numins> m_bcast_radix = { 0 };
+
+    std::array<bool, numins> m_tree_reduction = { false };
+
+    /* orders contributions to streaming terminals with reproducible reductions */
+    std::array<std::function<bool(const void *, const void *)>, numins> m_reduction_order;
+
+    detail::task_table<keyT> tasks_table;  //< tasks waiting for inputs
+    detail::task_table<keyT> constrained_tasks_table;  //< ready tasks deferred by a constraint
+
     std::vector<ttg::meta::detail::constraint_callback_t<keyT>> constraints_check;
     std::vector<ttg::meta::detail::constraint_callback_t<keyT>> constraints_complete;
 
@@ -1401,12 +1996,10 @@ namespace ttg_parsec {
     template <std::size_t i, typename Key>
     void get_pull_terminal_data_from(const int owner,
                                      const Key &key) {
-      using msg_t = detail::msg_t;
       auto &world_impl = world.impl();
       parsec_taskpool_t *tp = world_impl.taskpool();
-      std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), tp->taskpool_id,
-                                                            msg_header_t::MSG_GET_FROM_PULL, i,
-                                                            world.rank(), 1);
+      auto msg = detail::make_msg(pack_size(key), get_instance_id(), tp->taskpool_id,
+                                  msg_header_t::MSG_GET_FROM_PULL, i, world.rank(), 1);
       /* pack the key */
       size_t pos = 0;
       pos = pack(key, msg->bytes, pos);
@@ -1694,6 +2287,9 @@ namespace ttg_parsec {
             ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : executing");
         }
 
+        obj->reduce_ordered_inputs(task, std::make_index_sequence<numins>{});
+
+        detail::inline_window = true;
         if constexpr (!ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
           auto input = make_tuple_of_ref_from_array(task, std::make_index_sequence<numinvals>{});
           TTG_PROCESS_TT_OP_RETURN(suspended_task_address, task->coroutine_id, baseobj->op(task->key, std::move(input), obj->output_terminals));
@@ -1707,7 +2303,10 @@ namespace ttg_parsec {
         } else {
           ttg::abort();
         }
+        detail::inline_window = false;
         detail::parsec_ttg_caller = nullptr;
+        /* release the tasks made ready by the body in one batch */
+        detail::schedule_ready_tasks(obj->world.impl().execution_stream());
       }
       else {  // resume the suspended coroutine
 
@@ -1765,6 +2364,11 @@ namespace ttg_parsec {
 #ifdef TTG_HAVE_COROUTINE
       task->suspended_task_address = suspended_task_address;
 #endif // TTG_HAVE_COROUTINE
+      if (suspended_task_address != nullptr) {
+        /* do not hold back coalesced messages and ready tasks while the task is suspended */
+        detail::msg_aggregator::flush_all();
+        detail::schedule_inline_task(task->tt->world.impl().execution_stream());
+      }
       if (suspended_task_address == nullptr) {
         ttT *baseobj = task->tt;
         derivedT *obj = static_cast<derivedT *>(baseobj);
@@ -1881,6 +2485,13 @@ namespace ttg_parsec {
           detail::ttg_data_copy_t *source_copy;
           parsec_list_item_t *item;
           item = parsec_lifo_pop(&parent_task->streams[i].reduce_copies);
+          while (nullptr == item) {
+            /* a task combining contributions it popped will push the result back shortly (tree reductions) */
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (0 == parent_task->streams[i].combiners.load(std::memory_order_seq_cst)) break;
+            std::this_thread::yield();
+            item = parsec_lifo_pop(&parent_task->streams[i].reduce_copies);
+          }
           if (nullptr == item) {
             // maybe someone is changing the goal right now
             break;
@@ -1888,14 +2499,21 @@ namespace ttg_parsec {
           source_copy = ((detail::ttg_data_copy_self_t *)(item))->self;
           assert(target_copy->num_readers() == target_copy->mutable_tag);
           assert(source_copy->num_readers() > 0);
-          reducer(*reinterpret_cast<std::decay_t<value_t> *>(target_copy->get_ptr()),
-                  *reinterpret_cast<std::decay_t<value_t> *>(source_copy->get_ptr()));
-          detail::release_data_copy(source_copy);
+          if (baseobj->m_reduction_order[i]) {
+            /* ordered reductions are performed once all contributions have been received */
+            auto *&ordered_copies = parent_task->streams[i].ordered_copies;
+            if (nullptr == ordered_copies) ordered_copies = new std::vector<detail::ttg_data_copy_t *>();
+            ordered_copies->push_back(source_copy);
+          } else {
+            reducer(*reinterpret_cast<std::decay_t<value_t> *>(target_copy->get_ptr()),
+                    *reinterpret_cast<std::decay_t<value_t> *>(source_copy->get_ptr()));
+            detail::release_data_copy(source_copy);
+          }
         } else if constexpr(val_is_void) {
           reducer(); // invoke control reducer
         }
-        // there is only one task working on this stream, so no need to be atomic here
-        size = ++parent_task->streams[i].size;
+        // there is only one task working on this stream but senders may account for combined contributions
+        size = std::atomic_ref<std::size_t>(parent_task->streams[i].size).fetch_add(1, std::memory_order_relaxed) + 1;
         //std::cout << "static_reducer_op size " << size << " of " << parent_task->streams[i].goal << std::endl;
       } while ((c = (parent_task->streams[i].reduce_count.fetch_sub(1, std::memory_order_acq_rel)-1)) > 0);
       //} while ((c = (--task->streams[i].reduce_count)) > 0);
@@ -1954,11 +2572,88 @@ namespace ttg_parsec {
       return pos;
     }
 
+    /* keys whose binary representation is their object representation are aligned in messages
+     * so that the receiver can use them in place, see set_arg_from_msg */
+    static constexpr bool key_is_memcpyable() {
+      if constexpr (ttg::meta::is_void_v<keyT>) {
+        return false;
+      } else {
+        return ttg::detail::is_memcpyable_v<keyT> && !ttg::detail::is_user_buffer_serializable_v<keyT> &&
+               !ttg::has_split_metadata<keyT>::value;
+      }
+    }
+
+    static uint64_t align_key_offset(uint64_t pos) {
+      if constexpr (key_is_memcpyable()) {
+        pos = (pos + alignof(keyT) - 1) / alignof(keyT) * alignof(keyT);
+      }
+      return pos;
+    }
+
+    /* number of bytes pack() writes for obj */
+    template <typename T>
+    static uint64_t pack_size(const T &obj) {
+      using dd_t = ttg::default_data_descriptor<ttg::meta::remove_cvr_t<T>>;
+      uint64_t size = dd_t::payload_size(&obj);
+      if constexpr (!dd_t::serialize_size_is_const) {
+        size += sizeof(uint64_t);
+      }
+      return size;
+    }
+
     static void static_set_arg(void *data, std::size_t size, ttg::TTBase *bop) {
       assert(size >= sizeof(msg_header_t) &&
              "Trying to unpack as message that does not hold enough bytes to represent a single header");
       msg_header_t *hd = static_cast<msg_header_t *>(data);
       derivedT *obj = reinterpret_cast<derivedT *>(bop);
+      /* hand large messages off to a worker, unless they require RMA transfers started from the comm thread
+       * or target a streaming terminal: stream size and finalize messages are handled on the comm thread
+       * and must not overtake contributions that are still waiting to be unpacked */
+      if (size >= detail::unpack_offload_size && (0 == hd->num_iovecs || hd->inline_data) &&
+          0 <= hd->param_id && hd->param_id < static_cast<int32_t>(numins) &&
+          nullptr == obj->inpute_reducers_taskclass[hd->param_id]) {
+        obj->create_unpack_task(data, size);
+      } else {
+        static_set_arg_impl(data, size, bop);
+      }
+    }
+
+    /* unpacks a copy of a message on a worker thread, see static_set_arg */
+    static parsec_hook_return_t static_unpack_op(parsec_execution_stream_s *es, parsec_task_t *parsec_task) {
+      detail::unpack_task_t *task = reinterpret_cast<detail::unpack_task_t *>(parsec_task);
+      derivedT *obj = reinterpret_cast<derivedT *>(task->op);
+      static_set_arg_impl(task->data, task->size, task->op);
+      std::free(task->data);
+      obj->world.impl().decrement_inflight_msg();
+      return PARSEC_HOOK_RETURN_DONE;
+    }
+
+    static char *parsec_ttg_unpack_task_snprintf(char *buffer, size_t buffer_size, const parsec_task_t *parsec_task) {
+      if(buffer_size == 0)
+        return buffer;
+      snprintf(buffer, buffer_size, "%s()[]<%d>", parsec_task->task_class->name, parsec_task->priority);
+      return buffer;
+    }
+
+    void create_unpack_task(void *data, std::size_t size) {
+      static_assert(sizeof(task_t) >= sizeof(detail::unpack_task_t));
+      /* the message buffer is only valid for the duration of the callback so copy it */
+      void *data_cpy = std::malloc(size);
+      assert(data_cpy != nullptr);
+      std::memcpy(data_cpy, data, size);
+      auto &world_impl = world.impl();
+      parsec_thread_mempool_t *mempool = get_task_mempool();
+      auto *task = new (parsec_thread_mempool_allocate(mempool))
+          detail::unpack_task_t(mempool, &unpack_taskclass, world_impl.taskpool(), this, data_cpy, size);
+      /* keep the taskpool alive until the message has been unpacked */
+      world_impl.increment_inflight_msg();
+      parsec_task_t *vp_task_ring[1] = { &task->parsec_task };
+      __parsec_schedule_vp(world_impl.execution_stream(), vp_task_ring, 0);
+    }
+
+    static void static_set_arg_impl(void *data, std::size_t size, ttg::TTBase *bop) {
+      msg_header_t *hd = static_cast<msg_header_t *>(data);
+      derivedT *obj = reinterpret_cast<derivedT *>(bop);
       switch (hd->fn_id) {
         case msg_header_t::MSG_SET_ARG: {
           if (0 <= hd->param_id) {
@@ -1993,6 +2688,20 @@ namespace ttg_parsec {
           (obj->*member)(data, size);
           break;
         }
+        case msg_header_t::MSG_AGGREGATE: {
+          /* unpack the coalesced messages one by one, see detail::msg_aggregator */
+          unsigned char *bytes = static_cast<detail::msg_t *>(data)->bytes;
+          std::size_t pos = 0;
+          for (int m = 0; m < hd->num_keys; ++m) {
+            uint64_t msg_size;
+            std::memcpy(&msg_size, bytes + pos, sizeof(msg_size));
+            pos += sizeof(msg_size);
+            assert(sizeof(msg_header_t) + pos + msg_size <= size);
+            static_set_arg_impl(bytes + pos, msg_size, bop);
+            pos += detail::msg_aggregator::align(msg_size);
+          }
+          break;
+        }
         default:
           ttg::abort();
       }
@@ -2026,6 +2735,27 @@ namespace ttg_parsec {
       auto parsec_ttg_caller_save = detail::parsec_ttg_caller;
       detail::parsec_ttg_caller = dummy;
 
+      /* the keys may refer to the message buffer so they are never reordered in place */
+      std::vector<keyT> local_keys;
+      if (m_bcast_radix[i] > 0) {
+        /* tree-based broadcast: forward the keys of other processes in our subtree using the received copy */
+        auto rank = world.rank();
+        if (std::any_of(keylist.begin(), keylist.end(), [&](const keyT &key) { return keymap(key) != rank; })) {
+          std::vector<keyT> remote_keys;
+          for (auto &&key : keylist) {
+            if (keymap(key) == rank) {
+              local_keys.push_back(key);
+            } else {
+              remote_keys.push_back(key);
+            }
+          }
+          /* forwarding only serializes the value so it does not have to be copyable */
+          broadcast_arg<i>(ttg::span<const keyT>(remote_keys.data(), remote_keys.size()),
+                           *reinterpret_cast<valueT *>(copy->get_ptr()));
+          keylist = ttg::span<keyT>(local_keys.data(), local_keys.size());
+        }
+      }
+
       /* iterate over the keys and have them use the copy we made */
       parsec_task_t *task_ring = nullptr;
       for (auto &&key : keylist) {
@@ -2074,19 +2804,27 @@ namespace ttg_parsec {
       msg_t *msg = static_cast<msg_t *>(data);
       if constexpr (!ttg::meta::is_void_v<keyT>) {
         /* unpack the keys */
-        /* TODO: can we avoid copying all the keys?! */
         uint64_t pos = msg->tt_id.key_offset;
         uint64_t key_end_pos;
         std::vector<keyT> keylist;
+        ttg::span<keyT> keys;
         int num_keys = msg->tt_id.num_keys;
-        keylist.reserve(num_keys);
-        auto rank = world.rank();
-        for (int k = 0; k < num_keys; ++k) {
-          keyT key;
-          pos = unpack(key, msg->bytes, pos);
-          assert(keymap(key) == rank);
-          keylist.push_back(std::move(key));
+        if (key_is_memcpyable() && 0 == reinterpret_cast<std::uintptr_t>(msg->bytes + pos) % alignof(keyT)) {
+          /* use the keys in place */
+          keys = ttg::span<keyT>(reinterpret_cast<keyT *>(msg->bytes + pos), num_keys);
+          pos += num_keys * sizeof(keyT);
+        } else {
+          keylist.reserve(num_keys);
+          for (int k = 0; k < num_keys; ++k) {
+            keyT key;
+            pos = unpack(key, msg->bytes, pos);
+            keylist.push_back(std::move(key));
+          }
+          keys = ttg::span<keyT>(keylist.data(), num_keys);
         }
+        /* keys of other processes are forwarded in tree-based broadcasts */
+        assert(m_bcast_radix[i] > 0 ||
+               std::all_of(keys.begin(), keys.end(), [&](const keyT &key) { return keymap(key) == world.rank(); }));
         key_end_pos = pos;
         /* jump back to the beginning of the message to get the value */
         pos = 0;
@@ -2106,7 +2844,12 @@ namespace ttg_parsec {
 
             //std::cout << "set_arg_from_msg splitmd num_iovecs " << num_iovecs << std::endl;
 
-            copy = detail::create_new_datacopy(descr.create_from_metadata(metadata));
+            if constexpr (ttg::has_recycling_pool<decvalueT>::value) {
+              /* reuse a released value with the same metadata, if available */
+              copy = detail::create_new_datacopy(descr.create_from_metadata(metadata, ttg::recycling_pool<decvalueT>()));
+            } else {
+              copy = detail::create_new_datacopy(descr.create_from_metadata(metadata));
+            }
           } else if constexpr (!ttg::has_split_metadata<decvalueT>::value) {
             copy = detail::create_new_datacopy(decvalueT{});
 #if 0
@@ -2133,12 +2876,14 @@ namespace ttg_parsec {
               }
             }
 #endif // 0
-            /* unpack the object, potentially discovering iovecs */
-            pos = unpack(*static_cast<decvalueT *>(copy->get_ptr()), msg->bytes, pos);
+            if (!msg->tt_id.rendezvous) {
+              /* unpack the object, potentially discovering iovecs */
+              pos = unpack(*static_cast<decvalueT *>(copy->get_ptr()), msg->bytes, pos);
+            }
           }
 
           if (num_iovecs == 0) {
-            set_arg_from_msg_keylist<i, decvalueT>(ttg::span<keyT>(&keylist[0], num_keys), copy);
+            set_arg_from_msg_keylist<i, decvalueT>(std::move(keys), copy);
           } else {
             /* unpack the header and start the RMA transfers */
 
@@ -2160,7 +2905,7 @@ namespace ttg_parsec {
 
               /* create the value from the metadata */
               auto activation = new detail::rma_delayed_activate(
-                  std::move(keylist), copy, num_iovecs, [this](std::vector<keyT> &&keylist, detail::ttg_data_copy_t *copy) {
+                  std::vector<keyT>(keys.begin(), keys.end()), copy, num_iovecs, [this](std::vector<keyT> &&keylist, detail::ttg_data_copy_t *copy) {
                     set_arg_from_msg_keylist<i, decvalueT>(keylist, copy);
                     this->world.impl().decrement_inflight_msg();
                   });
@@ -2172,7 +2917,7 @@ namespace ttg_parsec {
               std::memcpy(iovec.data, msg->bytes + pos, iovec.num_bytes);
               pos += iovec.num_bytes;
             };
-            auto handle_iovec_fn = [&](auto&& iovec, auto activation) {
+            auto start_get_fn = [&](auto&& memreg, std::size_t num_bytes, auto activation) {
               using ActivationT = std::decay_t<decltype(*activation)>;
 
               ++nv;
@@ -2188,19 +2933,20 @@ namespace ttg_parsec {
               std::memcpy(&fn_ptr, msg->bytes + pos, sizeof(fn_ptr));
               pos += sizeof(fn_ptr);
 
-              /* register the local memory */
-              parsec_ce_mem_reg_handle_t lreg;
-              size_t lreg_size;
-              parsec_ce.mem_register(iovec.data, PARSEC_MEM_TYPE_NONCONTIGUOUS, iovec.num_bytes, parsec_datatype_int8_t,
-                                     iovec.num_bytes, &lreg, &lreg_size);
+              parsec_ce_mem_reg_handle_t lreg = static_cast<parsec_ce_mem_reg_handle_t>(memreg.first.get());
+              activation->add_memreg(std::move(memreg.first));
               world.impl().increment_inflight_msg();
               /* TODO: PaRSEC should treat the remote callback as a tag, not a function pointer! */
               //std::cout << "set_arg_from_msg: get rreg " << rreg << " remote " << remote << std::endl;
-              parsec_ce.get(&parsec_ce, lreg, 0, rreg, 0, iovec.num_bytes, remote,
+              parsec_ce.get(&parsec_ce, lreg, 0, rreg, 0, num_bytes, remote,
                             &detail::get_complete_cb<ActivationT>, activation,
                             /*world.impl().parsec_ttg_rma_tag()*/
                             cbtag, &fn_ptr, sizeof(std::intptr_t));
             };
+            auto handle_iovec_fn = [&](auto&& iovec, auto activation) {
+              /* register the local memory */
+              start_get_fn(copy->get_memreg(iovec.data, iovec.num_bytes), iovec.num_bytes, activation);
+            };
             if constexpr (ttg::has_split_metadata<decvalueT>::value) {
               ttg::SplitMetadataDescriptor<decvalueT> descr;
               if (inline_data) {
@@ -2214,7 +2960,24 @@ namespace ttg_parsec {
                 }
               }
             } else if constexpr (!ttg::has_split_metadata<decvalueT>::value) {
-              if (inline_data) {
+              if (msg->tt_id.rendezvous) {
+                /* read the serialized object from the sender's staging buffer, see pack_rendezvous */
+                std::memcpy(&cbtag, msg->bytes + pos, sizeof(cbtag));
+                pos += sizeof(cbtag);
+                uint64_t staging_size;
+                std::memcpy(&staging_size, msg->bytes + pos, sizeof(staging_size));
+                pos += sizeof(staging_size);
+                std::shared_ptr<unsigned char[]> staging(new unsigned char[staging_size]);
+                auto activation = new detail::rma_delayed_activate(
+                    std::vector<keyT>(keys.begin(), keys.end()), copy, 1, [this, staging](std::vector<keyT> &&keylist, detail::ttg_data_copy_t *copy) {
+                      unpack(*static_cast<decvalueT *>(copy->get_ptr()), staging.get(), 0);
+                      set_arg_from_msg_keylist<i, decvalueT>(keylist, copy);
+                      this->world.impl().decrement_inflight_msg();
+                    });
+                /* the staging buffer is not owned by the copy so do not cache its registration */
+                auto memreg = detail::memreg_cache::register_memory(staging.get(), staging_size);
+                start_get_fn(std::move(memreg), staging_size, activation);
+              } else if (inline_data) {
                 detail::foreach_parsec_data(val, [&](parsec_data_t* data){
                   read_inline_data(ttg::iovec{data->nb_elts, data->device_copies[data->owner_device]->device_private});
                 });
@@ -2230,12 +2993,12 @@ namespace ttg_parsec {
             assert(size == (key_end_pos + sizeof(msg_header_t)));
 
             if (inline_data) {
-              set_arg_from_msg_keylist<i, decvalueT>(ttg::span<keyT>(&keylist[0], num_keys), copy);
+              set_arg_from_msg_keylist<i, decvalueT>(std::move(keys), copy);
             }
           }
           // case 2 and 3
         } else if constexpr (!ttg::meta::is_void_v<keyT> && std::is_void_v<valueT>) {
-          for (auto &&key : keylist) {
+          for (auto &&key : keys) {
             set_arg<i, keyT, ttg::Void>(key, ttg::Void{});
           }
         }
@@ -2367,6 +3130,112 @@ namespace ttg_parsec {
     }
 
 
+    /* Tree reductions: combines the contribution in copy with one waiting to be folded into the input of task,
+     * on the calling thread, and puts the result back in place of the latter.
+     * Returns nullptr in that case, or the copy if it still has to be submitted.
+     * Only called from task bodies, contributions received from other processes are left to the reducer task. */
+    template <std::size_t i>
+    detail::ttg_data_copy_t *combine_contributions(task_t *task, detail::ttg_data_copy_t *copy) {
+      using valueT = std::decay_t<std::tuple_element_t<i, input_values_full_tuple_type>>;
+      if constexpr (!std::is_copy_constructible_v<valueT>) {
+        return copy;
+      } else {
+        auto &stream = task->streams[i];
+        /* announce ourselves before popping so the reducer task waits for the result instead of finishing */
+        stream.combiners.fetch_add(1, std::memory_order_seq_cst);
+        parsec_list_item_t *item = parsec_lifo_pop(&stream.reduce_copies);
+        if (nullptr == item) {
+          stream.combiners.fetch_sub(1, std::memory_order_seq_cst);
+          return copy;
+        }
+        detail::ttg_data_copy_t *other = ((detail::ttg_data_copy_self_t *)(item))->self;
+        if (copy->num_readers() != 1) {
+          /* the contribution is shared with other tasks, combine into a private copy */
+          detail::ttg_data_copy_t *private_copy = detail::create_new_datacopy(*static_cast<valueT *>(copy->get_ptr()));
+          detail::release_data_copy(copy);
+          copy = private_copy;
+        }
+        std::get<i>(input_reducers)(*static_cast<valueT *>(copy->get_ptr()), *static_cast<valueT *>(other->get_ptr()));
+        detail::release_data_copy(other);
+        /* account for the popped contribution, the combined copy takes its place in the stream */
+        std::atomic_ref<std::size_t>(stream.size).fetch_add(1, std::memory_order_relaxed);
+        parsec_lifo_push(&stream.reduce_copies, &copy->super);
+        stream.combiners.fetch_sub(1, std::memory_order_seq_cst);
+        return nullptr;
+      }
+    }
+
+    /* Ordered reductions: folds the contributions buffered by the reducer tasks into the input of the task,
+     * sorted by the order of the terminal and reduced pairwise in a tree whose shape only depends on their number.
+     * Only the left operands are copied, once, and contributions are released as soon as they have been consumed. */
+    template <std::size_t i>
+    void reduce_ordered_input(task_t *task) {
+      using valueT = std::decay_t<std::tuple_element_t<i, input_values_full_tuple_type>>;
+      if constexpr (!ttg::meta::is_void_v<valueT> && std::is_copy_constructible_v<valueT>) {
+        std::vector<detail::ttg_data_copy_t *> *ordered_copies = task->streams[i].ordered_copies;
+        if (nullptr == ordered_copies) return;
+        task->streams[i].ordered_copies = nullptr;
+
+        /* the copy of an operand is released once consumed, the input of the task has none */
+        struct operand_t {
+          valueT *value;
+          detail::ttg_data_copy_t *copy;
+        };
+        valueT *target = static_cast<valueT *>(task->copies[i]->get_ptr());
+        std::vector<operand_t> operands;
+        operands.reserve(ordered_copies->size() + 1);
+        operands.push_back(operand_t{target, nullptr});
+        for (auto *copy : *ordered_copies) {
+          operands.push_back(operand_t{static_cast<valueT *>(copy->get_ptr()), copy});
+        }
+        delete ordered_copies;
+        auto &order = m_reduction_order[i];
+        std::stable_sort(operands.begin(), operands.end(),
+                         [&](const operand_t &a, const operand_t &b) { return order(a.value, b.value); });
+
+        auto release = [](operand_t &op) {
+          if (nullptr != op.copy) {
+            detail::release_data_copy(op.copy);
+            op.copy = nullptr;
+          }
+        };
+        /* partial results, held by the left operand of each pair */
+        std::vector<std::optional<valueT>> partials(operands.size());
+        auto partial = [&](std::size_t j) -> valueT & {
+          if (!partials[j]) {
+            auto &op = operands[j];
+            if (nullptr == op.copy) {
+              /* the input of the task is private, no need to copy it */
+              partials[j].emplace(std::move(*op.value));
+            } else {
+              partials[j].emplace(*op.value);
+              release(op);
+            }
+          }
+          return *partials[j];
+        };
+        auto &reducer = std::get<i>(input_reducers);
+        for (std::size_t stride = 1; stride < operands.size(); stride *= 2) {
+          for (std::size_t j = 0; j + stride < operands.size(); j += 2 * stride) {
+            valueT &lhs = partial(j);
+            if (partials[j + stride]) {
+              reducer(lhs, *partials[j + stride]);
+              partials[j + stride].reset();
+            } else {
+              reducer(lhs, *operands[j + stride].value);
+              release(operands[j + stride]);
+            }
+          }
+        }
+        *target = std::move(partial(0));
+      }
+    }
+
+    template <std::size_t... Is>
+    void reduce_ordered_inputs(task_t *task, std::index_sequence<Is...>) {
+      (reduce_ordered_input<Is>(task), ...);
+    }
+
     template <std::size_t i>
     detail::reducer_task_t *create_new_reducer_task(task_t *task, bool is_first) {
       /* make sure we can reuse the existing memory pool and don't have to create a new one */
@@ -2405,11 +3274,10 @@ namespace ttg_parsec {
 
       ttg::trace(world.rank(), ":", get_name(), " : ", key, ": received value for argument : ", i);
 
-      parsec_key_t hk = 0;
       if constexpr (!keyT_is_Void) {
-        hk = reinterpret_cast<parsec_key_t>(&key);
         assert(keymap(key) == world.rank());
       }
+      auto ref = task_ref(key);
 
       task_t *task;
       auto &world_impl = world.impl();
@@ -2424,11 +3292,11 @@ namespace ttg_parsec {
       /* If we have only one input and no reducer on that input we can skip the hash table */
       if (numins > 1 || reducer) {
         has_lock = true;
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk))) {
+        tasks_table.lock(ref);
+        if (nullptr == (task = static_cast<task_t *>(tasks_table.nolock_find(ref)))) {
           task = create_new_task(key);
           world_impl.increment_created();
-          parsec_hash_table_nolock_insert(&tasks_table, &task->tt_ht_item);
+          tasks_table.nolock_insert(ref, task);
           get_pull_data = !is_lazy_pull();
           if( world_impl.dag_profiling() ) {
 #if defined(PARSEC_PROF_GRAPHER)
@@ -2438,12 +3306,12 @@ namespace ttg_parsec {
           }
         } else if (!reducer && numins == (task->in_data_count + 1)) {
           /* remove while we have the lock */
-          parsec_hash_table_nolock_remove(&tasks_table, hk);
+          tasks_table.nolock_remove(ref);
           remove_from_hash = false;
         }
         /* if we have a reducer, we need to hold on to the lock for just a little longer */
         if (!reducer) {
-          parsec_hash_table_unlock_bucket(&tasks_table, hk);
+          tasks_table.unlock(ref);
           has_lock = false;
         }
       } else {
@@ -2539,33 +3407,40 @@ namespace ttg_parsec {
             }
 
             /* now we can unlock the bucket */
-            parsec_hash_table_unlock_bucket(&tasks_table, hk);
+            tasks_table.unlock(ref);
           } else {
             /* unlock the bucket, the lock is not needed anymore */
-            parsec_hash_table_unlock_bucket(&tasks_table, hk);
+            tasks_table.unlock(ref);
 
             /* get the copy to use as input for this task */
             detail::ttg_data_copy_t *copy = get_copy_fn(task, std::forward<Value>(value), true);
 
-            /* enqueue the data copy to be reduced */
-            parsec_lifo_push(&task->streams[i].reduce_copies, &copy->super);
-            submit_reducer_task(task);
+            /* never run the user's reducer in message handlers, which are executed by the communication thread */
+            if (m_tree_reduction[i] && nullptr != detail::parsec_ttg_caller && !detail::parsec_ttg_caller->is_dummy()) {
+              copy = combine_contributions<i>(task, copy);
+            }
+
+            if (nullptr != copy) {
+              /* enqueue the data copy to be reduced */
+              parsec_lifo_push(&task->streams[i].reduce_copies, &copy->super);
+              submit_reducer_task(task);
+            }
           }
         } else {
           /* unlock the bucket, the lock is not needed anymore */
-          parsec_hash_table_unlock_bucket(&tasks_table, hk);
+          tasks_table.unlock(ref);
           /* submit reducer for void values to handle side effects */
           submit_reducer_task(task);
         }
         //if (release) {
-        //  parsec_hash_table_nolock_remove(&tasks_table, hk);
+        //  tasks_table.nolock_remove(ref);
         //  remove_from_hash = false;
         //}
-        //parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        //tasks_table.unlock(ref);
       } else {
         /* unlock the bucket, the lock is not needed anymore */
         if (has_lock) {
-          parsec_hash_table_unlock_bucket(&tasks_table, hk);
+          tasks_table.unlock(ref);
         }
         /* whether the task needs to be deferred or not */
         if constexpr (!valueT_is_Void) {
@@ -2609,7 +3484,11 @@ namespace ttg_parsec {
       }
       if (constrained) {
         // store the task so we can later access it once it is released
-        parsec_hash_table_insert(&task_constraint_table, &task->tt_ht_item);
+        if constexpr (ttg::meta::is_void_v<keyT>) {
+          constrained_tasks_table.insert(constrained_tasks_table.ref(), task);
+        } else {
+          constrained_tasks_table.insert(constrained_tasks_table.ref(task->key), task);
+        }
       }
       return !constrained;
     }
@@ -2628,8 +3507,7 @@ namespace ttg_parsec {
       if (release) {
         // no constraint blocked us
         task_t *task;
-        parsec_key_t hk = 0;
-        task = (task_t*)parsec_hash_table_remove(&task_constraint_table, hk);
+        task = static_cast<task_t *>(constrained_tasks_table.extract(constrained_tasks_table.ref()));
         assert(task != nullptr);
         auto &world_impl = world.impl();
         parsec_execution_stream_t *es = world_impl.execution_stream();
@@ -2654,8 +3532,7 @@ namespace ttg_parsec {
 
         if (release) {
           // no constraint blocked this task, so go ahead and release
-          auto hk = reinterpret_cast<parsec_key_t>(&key);
-          task = (task_t*)parsec_hash_table_remove(&task_constraint_table, hk);
+          task = static_cast<task_t *>(constrained_tasks_table.extract(constrained_tasks_table.ref(key)));
           assert(task != nullptr);
           if (task_ring == nullptr) {
             /* the first task is set directly */
@@ -2675,6 +3552,59 @@ namespace ttg_parsec {
       }
     }
 
+    /* holds a task made ready by the body of the running task to execute it once the running task
+     * completes, in the same execution stream and bypassing the scheduler (see set_inlining).
+     * Only one task is held: of the held and the new task, the one with the lower priority is added
+     * to the ready tasks. */
+    bool hold_for_inlining(task_t *task) {
+      if constexpr (derived_has_device_op()) {
+        return false;
+      } else {
+        if (!m_inline || !detail::inline_window || detail::inline_depth >= detail::max_inline_depth) {
+          return false;
+        }
+        parsec_task_t *held = detail::inline_task;
+        if (nullptr != held && held->priority > task->parsec_task.priority) {
+          return false;
+        }
+        if (nullptr != held) {
+          detail::push_ready_task(held);
+        }
+        detail::inline_task = &task->parsec_task;
+        return true;
+      }
+    }
+
+    /* executes a ready task synchronously, in the context of the running task that provided its last input,
+     * if the execution policy of this TT is ttg::Execution::Inline and the nesting depth permits */
+    bool execute_inline(task_t *task, parsec_execution_stream_t *es) {
+      if constexpr (derived_has_device_op()) {
+        return false;
+      } else {
+        detail::parsec_ttg_task_base_t *caller = detail::parsec_ttg_caller;
+        if (this->get_execution() != ttg::Execution::Inline || nullptr == caller || caller->is_dummy() ||
+            detail::inline_depth >= detail::max_inline_depth) {
+          return false;
+        }
+        /* the task runs as if it had been scheduled, so save the state of the running task */
+        bool inline_window = detail::inline_window;
+        parsec_task_t *inline_task = detail::inline_task;
+        std::size_t ready_begin = detail::ready_begin;
+        detail::inline_window = false;
+        detail::inline_task = nullptr;
+        detail::ready_begin = detail::ready_tasks.size();
+        detail::parsec_ttg_caller = nullptr;
+        ++detail::inline_depth;
+        __parsec_task_progress(es, &task->parsec_task, 0);
+        --detail::inline_depth;
+        detail::parsec_ttg_caller = caller;
+        detail::ready_begin = ready_begin;
+        detail::inline_task = inline_task;
+        detail::inline_window = inline_window;
+        return true;
+      }
+    }
+
     void release_task(task_t *task,
                       parsec_task_t **task_ring = nullptr) {
       constexpr const bool keyT_is_Void = ttg::meta::is_void_v<keyT>;
@@ -2695,7 +3625,6 @@ namespace ttg_parsec {
 
       if (count == numins) {
         parsec_execution_stream_t *es = world_impl.execution_stream();
-        parsec_key_t hk = task->pkey();
         if (tracing()) {
           if constexpr (!keyT_is_Void) {
             ttg::trace(world.rank(), ":", get_name(), " : ", task->key, ": submitting task for op ");
@@ -2703,12 +3632,25 @@ namespace ttg_parsec {
             ttg::trace(world.rank(), ":", get_name(), ": submitting task for op ");
           }
         }
-        if (task->remove_from_hash) parsec_hash_table_remove(&tasks_table, hk);
+        if (task->remove_from_hash) {
+          if constexpr (!keyT_is_Void) {
+            tasks_table.remove(task_ref(task->key));
+          } else {
+            tasks_table.remove(task_ref(ttg::Void{}));
+          }
+        }
 
         if (check_constraints(task)) {
           if (nullptr == task_ring) {
-            parsec_task_t *vp_task_rings[1] = { &task->parsec_task };
-            __parsec_schedule_vp(es, vp_task_rings, 0);
+            if (execute_inline(task, es) || hold_for_inlining(task)) {
+              /* executed or held for execution by this thread */
+            } else if (detail::inline_window) {
+              /* scheduled once the body of the running task returns */
+              detail::push_ready_task(&task->parsec_task);
+            } else {
+              parsec_task_t *vp_task_rings[1] = { &task->parsec_task };
+              __parsec_schedule_vp(es, vp_task_rings, 0);
+            }
           } else if (*task_ring == nullptr) {
             /* the first task is set directly */
             *task_ring = &task->parsec_task;
@@ -2750,37 +3692,104 @@ namespace ttg_parsec {
       set_arg_impl<i>(key, ttg::Void{});
     }
 
-    template<typename Value, typename Key>
-    bool can_inline_data(Value* value_ptr, detail::ttg_data_copy_t *copy, const Key& key, std::size_t num_keys) {
-      if constexpr (derived_has_device_op()) {
-        /* don't inline if data is possibly on the device */
-        return false;
-      }
-      /* non-device data */
+    /* serialized size of a value, computed once per send and shared by the checks below */
+    struct value_size_t {
+      std::size_t metadata = 0;  //< bytes needed to pack the value (or its metadata, for split-metadata types)
+      std::size_t iovs = 0;      //< bytes held in the buffers of the value
+      std::size_t num_iovs = 0;  //< number of buffers of the value
+    };
+
+    template<typename Value>
+    value_size_t value_size(Value* value_ptr) {
       using decvalueT = std::decay_t<Value>;
-      bool inline_data = false;
-      /* check whether to send data in inline */
-      std::size_t iov_size = 0;
-      std::size_t metadata_size = 0;
+      value_size_t size;
       if constexpr (ttg::has_split_metadata<std::decay_t<Value>>::value) {
         ttg::SplitMetadataDescriptor<decvalueT> descr;
         auto iovs = descr.get_data(*const_cast<decvalueT *>(value_ptr));
-        iov_size = std::accumulate(iovs.begin(), iovs.end(), 0,
-                                    [](std::size_t s, auto& iov){ return s + iov.num_bytes; });
+        for (auto&& iov : iovs) {
+          size.iovs += iov.num_bytes;
+          ++size.num_iovs;
+        }
         auto metadata = descr.get_metadata(*const_cast<decvalueT *>(value_ptr));
-        metadata_size = ttg::default_data_descriptor<decltype(metadata)>::payload_size(&metadata);
+        size.metadata = pack_size(metadata);
       } else {
         /* TODO: how can we query the iovecs of the buffers here without actually packing the data? */
-        metadata_size = ttg::default_data_descriptor<ttg::meta::remove_cvr_t<Value>>::payload_size(value_ptr);
-        detail::foreach_parsec_data(*value_ptr, [&](parsec_data_t* data){ iov_size += data->nb_elts; });
+        size.metadata = pack_size(*value_ptr);
+        detail::foreach_parsec_data(*value_ptr, [&](parsec_data_t* data){
+          size.iovs += data->nb_elts;
+          ++size.num_iovs;
+        });
+      }
+      return size;
+    }
+
+    /* number of bytes needed to pack a value of the given size and num_keys keys inline into a message */
+    template<typename Key>
+    std::size_t inline_msg_size(const value_size_t& size, const Key& key, std::size_t num_keys) {
+      /* keys are packed at the end, potentially after some padding to align them */
+      std::size_t key_pack_size = 0;
+      std::size_t key_padding = 0;
+      if constexpr (!ttg::meta::is_void_v<Key>) {
+        key_pack_size = pack_size(key);
+        if constexpr (key_is_memcpyable()) {
+          key_padding = alignof(keyT) - 1;
+        }
       }
-      /* key is packed at the end */
-      std::size_t key_pack_size = ttg::default_data_descriptor<Key>::payload_size(&key);
-      std::size_t pack_size = key_pack_size + metadata_size + iov_size;
-      if (pack_size < detail::max_inline_size) {
-        inline_data = true;
+      return num_keys*key_pack_size + key_padding + size.metadata + size.iovs;
+    }
+
+    template<typename Key>
+    bool can_inline_data(const value_size_t& size, detail::ttg_data_copy_t *copy, const Key& key, std::size_t num_keys) {
+      if constexpr (derived_has_device_op()) {
+        /* don't inline if data is possibly on the device */
+        return false;
+      }
+      /* non-device data */
+      return inline_msg_size(size, key, num_keys) < detail::max_inline_size;
+    }
+
+    /* whether the serialized value is too large to be packed into the message, see make_rendezvous_buffer */
+    template<typename Value, typename Key>
+    bool needs_rendezvous(const value_size_t& size, const Key& key) {
+      if constexpr (ttg::meta::is_void_v<Key> || ttg::has_split_metadata<std::decay_t<Value>>::value) {
+        /* split-metadata values are transferred using RMA already */
+        return false;
+      } else {
+        /* values containing buffers are serialized into the message alongside the buffer registrations */
+        return 0 == size.num_iovs && size.metadata > detail::rendezvous_size;
       }
-      return inline_data;
+    }
+
+    /* serializes value (of size bytes when packed) into a registered staging buffer, which the receiver reads through RMA */
+    template<typename Value>
+    std::shared_ptr<detail::rendezvous_buffer_t> make_rendezvous_buffer(const Value& value, std::size_t size) {
+      auto buffer = std::make_shared<detail::rendezvous_buffer_t>();
+      buffer->size = size;
+      buffer->data.reset(new unsigned char[buffer->size]);
+      pack(value, buffer->data.get(), 0);
+      std::tie(buffer->memreg, buffer->memreg_size) =
+          detail::memreg_cache::register_memory(buffer->data.get(), buffer->size);
+      return buffer;
+    }
+
+    /**
+     * pack the descriptor of a staging buffer, the buffer is released once the receiver completed the transfer
+     * memory layout: [<size, lreg_size, lreg, release_cb_ptr>]
+     */
+    static uint64_t pack_rendezvous(std::shared_ptr<detail::rendezvous_buffer_t> buffer, unsigned char *bytes, uint64_t pos) {
+      std::memcpy(bytes + pos, &buffer->size, sizeof(buffer->size));
+      pos += sizeof(buffer->size);
+      std::memcpy(bytes + pos, &buffer->memreg_size, sizeof(buffer->memreg_size));
+      pos += sizeof(buffer->memreg_size);
+      std::memcpy(bytes + pos, buffer->memreg.get(), buffer->memreg_size);
+      pos += buffer->memreg_size;
+      std::function<void(void)> *fn = new std::function<void(void)>([=]() mutable {
+        buffer.reset();
+      });
+      std::intptr_t fn_ptr{reinterpret_cast<std::intptr_t>(fn)};
+      std::memcpy(bytes + pos, &fn_ptr, sizeof(fn_ptr));
+      pos += sizeof(fn_ptr);
+      return pos;
     }
 
     // Used to set the i'th argument
@@ -2816,12 +3825,10 @@ namespace ttg_parsec {
       // the target task is remote. Pack the information and send it to
       // the corresponding peer.
       // TODO do we need to copy value?
-      using msg_t = detail::msg_t;
       auto &world_impl = world.impl();
       uint64_t pos = 0;
       int num_iovecs = 0;
-      std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                           msg_header_t::MSG_SET_ARG, i, world_impl.rank(), 1);
+      detail::msg_ptr_t msg;
 
       if constexpr (!ttg::meta::is_void_v<decvalueT>) {
 
@@ -2837,8 +3844,16 @@ namespace ttg_parsec {
           }
         }
 
-        bool inline_data = can_inline_data(value_ptr, copy, key, 1);
+        auto size = value_size(value_ptr);
+        bool rendezvous = needs_rendezvous<norefvalueT>(size, key);
+        bool inline_data = !rendezvous && can_inline_data(size, copy, key, 1);
+        /* inline messages are packed into a buffer of matching size, the size of the
+         * registration handles is not known upfront so use the largest buffer otherwise */
+        msg = detail::make_msg(inline_data ? inline_msg_size(size, key, 1) : detail::msg_t::max_payload_size,
+                               get_instance_id(), world_impl.taskpool()->taskpool_id, msg_header_t::MSG_SET_ARG, i,
+                               world_impl.rank(), 1);
         msg->tt_id.inline_data = inline_data;
+        msg->tt_id.rendezvous = rendezvous;
 
         auto write_header_fn = [&]() {
           if (!inline_data) {
@@ -2863,20 +3878,14 @@ namespace ttg_parsec {
              * memory layout: [<lreg_size, lreg, release_cb_ptr>, ...]
              */
             copy = detail::register_data_copy<decvalueT>(copy, nullptr, true);
-            parsec_ce_mem_reg_handle_t lreg;
-            size_t lreg_size;
-            /* TODO: only register once when we can broadcast the data! */
-            parsec_ce.mem_register(iovec.data, PARSEC_MEM_TYPE_NONCONTIGUOUS, iovec.num_bytes, parsec_datatype_int8_t,
-                                   iovec.num_bytes, &lreg, &lreg_size);
-            auto lreg_ptr = std::shared_ptr<void>{lreg, [](void *ptr) {
-                                                    parsec_ce_mem_reg_handle_t memreg = (parsec_ce_mem_reg_handle_t)ptr;
-                                                    parsec_ce.mem_unregister(&memreg);
-                                                  }};
-            int32_t lreg_size_i = lreg_size;
+            /* registrations are cached for the lifetime of the copy */
+            auto memreg = copy->get_memreg(iovec.data, iovec.num_bytes);
+            auto lreg_ptr = memreg.first;
+            int32_t lreg_size_i = memreg.second;
             std::memcpy(msg->bytes + pos, &lreg_size_i, sizeof(lreg_size_i));
             pos += sizeof(lreg_size_i);
-            std::memcpy(msg->bytes + pos, lreg, lreg_size);
-            pos += lreg_size;
+            std::memcpy(msg->bytes + pos, lreg_ptr.get(), lreg_size_i);
+            pos += lreg_size_i;
             //std::cout << "set_arg_impl lreg " << lreg << std::endl;
             /* TODO: can we avoid the extra indirection of going through std::function? */
             std::function<void(void)> *fn = new std::function<void(void)>([=]() mutable {
@@ -2904,22 +3913,37 @@ namespace ttg_parsec {
             handle_iovec_fn(iov);
           }
         } else if constexpr (!ttg::has_split_metadata<std::decay_t<Value>>::value) {
-          /* serialize the object */
-          pos = pack(*value_ptr, msg->bytes, pos, copy);
-          detail::foreach_parsec_data(value, [&](parsec_data_t *data){ ++num_iovecs; });
-          //std::cout << "POST pack num_iovecs " << num_iovecs << std::endl;
-          /* handle any iovecs contained in it */
-          write_header_fn();
-          detail::foreach_parsec_data(value, [&](parsec_data_t *data){
-            handle_iovec_fn(ttg::iovec{data->nb_elts, data->device_copies[data->owner_device]->device_private});
-          });
+          if (rendezvous) {
+            /* serialize the object into a staging buffer that is transferred like a single iovec */
+            num_iovecs = 1;
+            write_header_fn();
+            pos = pack_rendezvous(make_rendezvous_buffer(*value_ptr, size.metadata), msg->bytes, pos);
+          } else {
+            /* serialize the object */
+            pos = pack(*value_ptr, msg->bytes, pos, copy);
+            detail::foreach_parsec_data(value, [&](parsec_data_t *data){ ++num_iovecs; });
+            //std::cout << "POST pack num_iovecs " << num_iovecs << std::endl;
+            /* handle any iovecs contained in it */
+            write_header_fn();
+            detail::foreach_parsec_data(value, [&](parsec_data_t *data){
+              handle_iovec_fn(ttg::iovec{data->nb_elts, data->device_copies[data->owner_device]->device_private});
+            });
+          }
         }
 
         msg->tt_id.num_iovecs = num_iovecs;
+      } else {
+        std::size_t key_size = 0;
+        if constexpr (!ttg::meta::is_void_v<Key>) {
+          key_size = pack_size(key);
+        }
+        msg = detail::make_msg(key_size, get_instance_id(), world_impl.taskpool()->taskpool_id,
+                               msg_header_t::MSG_SET_ARG, i, world_impl.rank(), 1);
       }
 
       /* pack the key */
       msg->tt_id.num_keys = 0;
+      pos = align_key_offset(pos);
       msg->tt_id.key_offset = pos;
       if constexpr (!ttg::meta::is_void_v<Key>) {
         size_t tmppos = pack(key, msg->bytes, pos);
@@ -2928,11 +3952,18 @@ namespace ttg_parsec {
       }
 
       parsec_taskpool_t *tp = world_impl.taskpool();
-      tp->tdm.module->outgoing_message_start(tp, owner, NULL);
-      tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
-      //std::cout << "set_arg_impl send_am owner " << owner << " sender " << msg->tt_id.sender << std::endl;
-      parsec_ce.send_am(&parsec_ce, world_impl.parsec_ttg_tag(), owner, static_cast<void *>(msg.get()),
-                        sizeof(msg_header_t) + pos);
+      /* coalesce small messages sent from task bodies, they are flushed once the task completes */
+      bool aggregated = m_aggregate_input[i] && (0 == msg->tt_id.num_iovecs || msg->tt_id.inline_data) &&
+                        nullptr != detail::parsec_ttg_caller && !detail::parsec_ttg_caller->is_dummy() &&
+                        detail::msg_aggregator::append(owner, msg.get(), sizeof(msg_header_t) + pos, tp,
+                                                       world_impl.parsec_ttg_tag());
+      if (!aggregated) {
+        tp->tdm.module->outgoing_message_start(tp, owner, NULL);
+        tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
+        //std::cout << "set_arg_impl send_am owner " << owner << " sender " << msg->tt_id.sender << std::endl;
+        parsec_ce.send_am(&parsec_ce, world_impl.parsec_ttg_tag(), owner, static_cast<void *>(msg.get()),
+                          sizeof(msg_header_t) + pos);
+      }
 #if defined(PARSEC_PROF_TRACE) && defined(PARSEC_TTG_PROFILE_BACKEND)
       if(world.impl().profiling()) {
         parsec_profiling_ts_trace(world.impl().parsec_ttg_profile_backend_set_arg_end, 0, 0, NULL);
@@ -3024,17 +4055,28 @@ namespace ttg_parsec {
         copy = detail::find_copy_in_task(detail::parsec_ttg_caller, &value);
         assert(nullptr != copy);
 
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_SET_ARG, i, world_impl.rank());
 
         /* check if we inline the data */
         /* TODO: this assumes the worst case: that all keys are packed at once (i.e., go to the same remote). Can we do better?*/
-        bool inline_data = can_inline_data(&value, copy, keylist_sorted[0], keylist_sorted.size());
+        auto size = value_size(&value);
+        bool rendezvous = needs_rendezvous<Value>(size, keylist_sorted[0]);
+        bool inline_data = !rendezvous && can_inline_data(size, copy, keylist_sorted[0], keylist_sorted.size());
+        /* the same buffer is reused for all remote owners so size it for the worst case */
+        std::size_t msg_size = detail::msg_t::max_payload_size;
+        if (inline_data) {
+          msg_size = std::accumulate(keylist_sorted.begin(), keylist_sorted.end(),
+                                     inline_msg_size(size, keylist_sorted[0], 0),
+                                     [](std::size_t s, const Key& key){ return s + pack_size(key); });
+        }
+        auto msg = detail::make_msg(msg_size, get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                    msg_header_t::MSG_SET_ARG, i, world_impl.rank());
         msg->tt_id.inline_data = inline_data;
+        msg->tt_id.rendezvous = rendezvous;
 
         std::vector<std::pair<int32_t, std::shared_ptr<void>>> memregs;
+        /* staging buffer shared by all receivers */
+        std::shared_ptr<detail::rendezvous_buffer_t> rendezvous_buffer;
         auto write_iov_header = [&](){
           if (!inline_data) {
             /* TODO: at the moment, the tag argument to parsec_ce.get() is treated as a
@@ -3051,20 +4093,9 @@ namespace ttg_parsec {
             std::memcpy(msg->bytes + pos, iovec.data, iovec.num_bytes);
             pos += iovec.num_bytes;
           } else {
-            parsec_ce_mem_reg_handle_t lreg;
-            size_t lreg_size;
-            parsec_ce.mem_register(iovec.data, PARSEC_MEM_TYPE_NONCONTIGUOUS, iovec.num_bytes, parsec_datatype_int8_t,
-                                   iovec.num_bytes, &lreg, &lreg_size);
-            /* TODO: use a static function for deregistration here? */
-            memregs.push_back(std::make_pair(static_cast<int32_t>(lreg_size),
-                                            /* TODO: this assumes that parsec_ce_mem_reg_handle_t is void* */
-                                            std::shared_ptr<void>{lreg, [](void *ptr) {
-                                                                    parsec_ce_mem_reg_handle_t memreg =
-                                                                        (parsec_ce_mem_reg_handle_t)ptr;
-                                                                    //std::cout << "broadcast_arg memunreg lreg " << memreg << std::endl;
-                                                                    parsec_ce.mem_unregister(&memreg);
-                                                                  }}));
-            //std::cout << "broadcast_arg memreg lreg " << lreg << std::endl;
+            /* registrations are cached for the lifetime of the copy */
+            auto memreg = copy->get_memreg(iovec.data, iovec.num_bytes);
+            memregs.push_back(std::make_pair(memreg.second, std::move(memreg.first)));
           }
         };
 
@@ -3082,21 +4113,45 @@ namespace ttg_parsec {
           }
           //std::cout << "broadcast_arg splitmd num_iovecs " << num_iovs << std::endl;
         } else if constexpr (!ttg::has_split_metadata<std::decay_t<Value>>::value) {
-          /* serialize the object once */
-          pos = pack(value, msg->bytes, pos, copy);
-          detail::foreach_parsec_data(value, [&](parsec_data_t *data){ ++num_iovs; });
-          memregs.reserve(num_iovs);
-          write_iov_header();
-          detail::foreach_parsec_data(value, [&](parsec_data_t *data){
-            handle_iov_fn(ttg::iovec{data->nb_elts,
-                                     data->device_copies[data->owner_device]->device_private});
-          });
+          if (rendezvous) {
+            /* serialize the object once into a staging buffer */
+            rendezvous_buffer = make_rendezvous_buffer(value, size.metadata);
+            num_iovs = 1;
+            write_iov_header();
+          } else {
+            /* serialize the object once */
+            pos = pack(value, msg->bytes, pos, copy);
+            detail::foreach_parsec_data(value, [&](parsec_data_t *data){ ++num_iovs; });
+            memregs.reserve(num_iovs);
+            write_iov_header();
+            detail::foreach_parsec_data(value, [&](parsec_data_t *data){
+              handle_iov_fn(ttg::iovec{data->nb_elts,
+                                       data->device_copies[data->owner_device]->device_private});
+            });
+          }
         }
 
         msg->tt_id.num_iovecs = num_iovs;
 
         std::size_t save_pos = pos;
 
+        /* With tree-based forwarding, the remote owners are split into at most m_bcast_radix[i]
+         * groups of consecutive owners. All keys of a group are sent to the first owner in the group,
+         * which forwards them to the remaining owners of its group (see set_arg_from_msg_keylist). */
+        std::size_t owners_per_group = 1;
+        if (m_bcast_radix[i] > 0) {
+          std::size_t num_remote_owners = 0;
+          int prev_owner = rank;
+          for (auto &key : keylist_sorted) {
+            int owner = keymap(key);
+            if (owner != prev_owner) {
+              ++num_remote_owners;
+              prev_owner = owner;
+            }
+          }
+          owners_per_group = (num_remote_owners + m_bcast_radix[i] - 1) / m_bcast_radix[i];
+        }
+
         parsec_taskpool_t *tp = world_impl.taskpool();
         for (auto it = keylist_sorted.begin(); it < keylist_sorted.end(); /* increment done inline */) {
 
@@ -3117,7 +4172,9 @@ namespace ttg_parsec {
            * memory layout: [<lreg_size, lreg, lreg_fn>, ...]
            * NOTE: we need to pack these for every receiver to ensure correct ref-counting of the registration
            */
-          if (!inline_data) {
+          if (rendezvous) {
+            pos = pack_rendezvous(rendezvous_buffer, msg->bytes, pos);
+          } else if (!inline_data) {
             for (int idx = 0; idx < num_iovs; ++idx) {
               // auto [lreg_size, lreg_ptr] = memregs[idx];
               int32_t lreg_size;
@@ -3144,15 +4201,25 @@ namespace ttg_parsec {
           }
 
           /* mark the beginning of the keys */
+          pos = align_key_offset(pos);
           msg->tt_id.key_offset = pos;
 
-          /* pack all keys for this owner */
+          /* pack all keys for this owner and the other owners in its group */
           int num_keys = 0;
-          do {
+          int key_owner = owner;
+          std::size_t num_group_owners = 1;
+          while (true) {
             ++num_keys;
             pos = pack(*it, msg->bytes, pos);
             ++it;
-          } while (it < keylist_sorted.end() && keymap(*it) == owner);
+            if (it == keylist_sorted.end()) break;
+            int next_owner = keymap(*it);
+            if (next_owner != key_owner) {
+              if (num_group_owners == owners_per_group) break;
+              ++num_group_owners;
+              key_owner = next_owner;
+            }
+          }
           msg->tt_id.num_keys = num_keys;
 
           tp->tdm.module->outgoing_message_start(tp, owner, NULL);
@@ -3161,11 +4228,17 @@ namespace ttg_parsec {
           parsec_ce.send_am(&parsec_ce, world_impl.parsec_ttg_tag(), owner, static_cast<void *>(msg.get()),
                             sizeof(msg_header_t) + pos);
         }
-        /* handle local keys */
-        broadcast_arg_local<i>(local_begin, local_end, value);
-      } else {
+        /* handle local keys, there are none when forwarding the keys of a tree-based broadcast */
+        if constexpr (std::is_copy_constructible_v<decvalueT>) {
+          broadcast_arg_local<i>(local_begin, local_end, value);
+        } else {
+          assert(local_begin == local_end);
+        }
+      } else if constexpr (std::is_copy_constructible_v<std::decay_t<Value>>) {
         /* handle local keys */
         broadcast_arg_local<i>(keylist.begin(), keylist.end(), value);
+      } else {
+        assert(keylist.empty());
       }
     }
 
@@ -3242,15 +4315,16 @@ namespace ttg_parsec {
       const auto owner = keymap(key);
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), ":", key, " : forwarding stream size for terminal ", i);
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
         uint64_t pos = 0;
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_SET_ARGSTREAM_SIZE, i,
-                                                             world_impl.rank(), 1);
+        auto msg = detail::make_msg(pack_size(key) + pack_size(size), get_instance_id(),
+                                    world_impl.taskpool()->taskpool_id, msg_header_t::MSG_SET_ARGSTREAM_SIZE, i,
+                                    world_impl.rank(), 1);
         /* pack the key */
         pos = pack(key, msg->bytes, pos);
         pos = pack(size, msg->bytes, pos);
+        /* contributions coalesced by this thread must arrive first */
+        detail::msg_aggregator::flush(owner, get_instance_id(), i);
         parsec_taskpool_t *tp = world_impl.taskpool();
         tp->tdm.module->outgoing_message_start(tp, owner, NULL);
         tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
@@ -3259,20 +4333,20 @@ namespace ttg_parsec {
       } else {
         ttg::trace(world.rank(), ":", get_name(), ":", key, " : setting stream size to ", size, " for terminal ", i);
 
-        auto hk = reinterpret_cast<parsec_key_t>(&key);
+        auto ref = task_ref(key);
         task_t *task;
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk))) {
+        tasks_table.lock(ref);
+        if (nullptr == (task = static_cast<task_t *>(tasks_table.nolock_find(ref)))) {
           task = create_new_task(key);
           world.impl().increment_created();
-          parsec_hash_table_nolock_insert(&tasks_table, &task->tt_ht_item);
+          tasks_table.nolock_insert(ref, task);
           if( world.impl().dag_profiling() ) {
 #if defined(PARSEC_PROF_GRAPHER)
             parsec_prof_grapher_task(&task->parsec_task, world.impl().execution_stream()->th_id, 0, *(uintptr_t*)&(task->parsec_task.locals[0]));
 #endif
           }
         }
-        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        tasks_table.unlock(ref);
 
         // TODO: Unfriendly implementation, cannot check if stream is already bounded
         // TODO: Unfriendly implementation, cannot check if stream has been finalized already
@@ -3303,13 +4377,13 @@ namespace ttg_parsec {
       const auto owner = keymap();
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), " : forwarding stream size for terminal ", i);
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
         uint64_t pos = 0;
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_SET_ARGSTREAM_SIZE, i,
-                                                             world_impl.rank(), 0);
+        auto msg = detail::make_msg(pack_size(size), get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                    msg_header_t::MSG_SET_ARGSTREAM_SIZE, i, world_impl.rank(), 0);
         pos = pack(size, msg->bytes, pos);
+        /* contributions coalesced by this thread must arrive first */
+        detail::msg_aggregator::flush(owner, get_instance_id(), i);
         parsec_taskpool_t *tp = world_impl.taskpool();
         tp->tdm.module->outgoing_message_start(tp, owner, NULL);
         tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
@@ -3318,20 +4392,20 @@ namespace ttg_parsec {
       } else {
         ttg::trace(world.rank(), ":", get_name(), " : setting stream size to ", size, " for terminal ", i);
 
-        parsec_key_t hk = 0;
+        auto ref = task_ref(ttg::Void{});
         task_t *task;
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk))) {
+        tasks_table.lock(ref);
+        if (nullptr == (task = static_cast<task_t *>(tasks_table.nolock_find(ref)))) {
           task = create_new_task(ttg::Void{});
           world.impl().increment_created();
-          parsec_hash_table_nolock_insert(&tasks_table, &task->tt_ht_item);
+          tasks_table.nolock_insert(ref, task);
           if( world.impl().dag_profiling() ) {
 #if defined(PARSEC_PROF_GRAPHER)
             parsec_prof_grapher_task(&task->parsec_task, world.impl().execution_stream()->th_id, 0, *(uintptr_t*)&(task->parsec_task.locals[0]));
 #endif
           }
         }
-        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        tasks_table.unlock(ref);
 
         // TODO: Unfriendly implementation, cannot check if stream is already bounded
         // TODO: Unfriendly implementation, cannot check if stream has been finalized already
@@ -3360,14 +4434,14 @@ namespace ttg_parsec {
       const auto owner = keymap(key);
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), " : ", key, ": forwarding stream finalize for terminal ", i);
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
         uint64_t pos = 0;
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_FINALIZE_ARGSTREAM_SIZE, i,
-                                                             world_impl.rank(), 1);
+        auto msg = detail::make_msg(pack_size(key), get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                    msg_header_t::MSG_FINALIZE_ARGSTREAM_SIZE, i, world_impl.rank(), 1);
         /* pack the key */
         pos = pack(key, msg->bytes, pos);
+        /* contributions coalesced by this thread must arrive first */
+        detail::msg_aggregator::flush(owner, get_instance_id(), i);
         parsec_taskpool_t *tp = world_impl.taskpool();
         tp->tdm.module->outgoing_message_start(tp, owner, NULL);
         tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
@@ -3376,10 +4450,8 @@ namespace ttg_parsec {
       } else {
         ttg::trace(world.rank(), ":", get_name(), " : ", key, ": finalizing stream for terminal ", i);
 
-        auto hk = reinterpret_cast<parsec_key_t>(&key);
         task_t *task = nullptr;
-        //parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_find(&tasks_table, hk))) {
+        if (nullptr == (task = static_cast<task_t *>(tasks_table.find(task_ref(key))))) {
           ttg::print_error(world.rank(), ":", get_name(), ":", key,
                            " : error finalize called on stream that never received an input data: ", i);
           throw std::runtime_error("TT::finalize called on stream that never received an input data");
@@ -3412,12 +4484,12 @@ namespace ttg_parsec {
       const auto owner = keymap();
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), ": forwarding stream finalize for terminal ", i);
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
         uint64_t pos = 0;
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_FINALIZE_ARGSTREAM_SIZE, i,
-                                                             world_impl.rank(), 0);
+        auto msg = detail::make_msg(0, get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                    msg_header_t::MSG_FINALIZE_ARGSTREAM_SIZE, i, world_impl.rank(), 0);
+        /* contributions coalesced by this thread must arrive first */
+        detail::msg_aggregator::flush(owner, get_instance_id(), i);
         parsec_taskpool_t *tp = world_impl.taskpool();
         tp->tdm.module->outgoing_message_start(tp, owner, NULL);
         tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
@@ -3426,9 +4498,8 @@ namespace ttg_parsec {
       } else {
         ttg::trace(world.rank(), ":", get_name(), ": finalizing stream for terminal ", i);
 
-        auto hk = static_cast<parsec_key_t>(0);
         task_t *task = nullptr;
-        if (nullptr == (task = (task_t *)parsec_hash_table_find(&tasks_table, hk))) {
+        if (nullptr == (task = static_cast<task_t *>(tasks_table.find(task_ref(ttg::Void{}))))) {
           ttg::print_error(world.rank(), ":", get_name(),
                            " : error finalize called on stream that never received an input data: ", i);
           throw std::runtime_error("TT::finalize called on stream that never received an input data");
@@ -3825,6 +4896,16 @@ namespace ttg_parsec {
 
     parsec_key_fn_t tasks_hash_fcts = {key_equal, key_print, key_hash};
 
+    /* the location of the task with the given key in tasks_table */
+    template <typename Key>
+    auto task_ref(const Key &key) {
+      if constexpr (ttg::meta::is_void_v<keyT>) {
+        return tasks_table.ref();
+      } else {
+        return tasks_table.ref(key);
+      }
+    }
+
     static parsec_hook_return_t complete_task_and_release(parsec_execution_stream_t *es, parsec_task_t *parsec_task) {
 
       //std::cout << "complete_task_and_release: task " << parsec_task << std::endl;
@@ -3864,6 +4945,9 @@ namespace ttg_parsec {
       }
 #endif // TTG_HAVE_COROUTINE
 
+      /* send messages coalesced during the execution of the task */
+      detail::msg_aggregator::flush_all();
+
       /* release our data copies */
       for (int i = 0; i < task->data_count; i++) {
         detail::ttg_data_copy_t *copy = task->copies[i];
@@ -3879,6 +4963,9 @@ namespace ttg_parsec {
           c(task->key);
         }
       }
+
+      /* run the successor held back during the execution of the task */
+      detail::execute_inline_task(es);
       return PARSEC_HOOK_RETURN_DONE;
     }
 
@@ -3947,6 +5034,21 @@ namespace ttg_parsec {
 
       world_impl.taskpool()->nb_task_classes = std::max(world_impl.taskpool()->nb_task_classes, static_cast<decltype(world_impl.taskpool()->nb_task_classes)>(self.task_class_id+1));
       //    function_id_to_instance[self.task_class_id] = this;
+
+      /* unpack tasks are not visible to the termination detection, see create_unpack_task */
+      std::memset(&unpack_taskclass, 0, sizeof(unpack_taskclass));
+      unpack_taskclass.name = self.name;
+      unpack_taskclass.task_class_id = self.task_class_id;
+      unpack_taskclass.task_snprintf = parsec_ttg_unpack_task_snprintf;
+      unpack_chores[0].type = PARSEC_DEV_CPU;
+      unpack_chores[0].evaluate = NULL;
+      unpack_chores[0].hook = &static_unpack_op;
+      unpack_chores[1].type = PARSEC_DEV_NONE;
+      unpack_chores[1].evaluate = NULL;
+      unpack_chores[1].hook = NULL;
+      unpack_taskclass.incarnations = unpack_chores;
+      unpack_taskclass.release_task = &parsec_release_task_to_mempool;
+      unpack_taskclass.complete_execution = NULL;
       //self.incarnations = incarnations_array.data();
 //#if 0
       if constexpr (derived_has_cuda_op()) {
@@ -4031,11 +5133,10 @@ namespace ttg_parsec {
       parsec_mempool_construct(&mempools, PARSEC_OBJ_CLASS(parsec_task_t), sizeof(task_t),
                                offsetof(parsec_task_t, mempool_owner), nbthreads);
 
-      parsec_hash_table_init(&tasks_table, offsetof(detail::parsec_ttg_task_base_t, tt_ht_item), 8, tasks_hash_fcts,
-                             NULL);
+      /* one shard per thread to limit contention */
+      tasks_table.init(0, nbthreads, tasks_hash_fcts);
 
-      parsec_hash_table_init(&task_constraint_table, offsetof(detail::parsec_ttg_task_base_t, tt_ht_item), 8, tasks_hash_fcts,
-                             NULL);
+      constrained_tasks_table.init(0, nbthreads, tasks_hash_fcts);
     }
 
     template <typename keymapT = ttg::detail::default_keymap<keyT>,
@@ -4082,18 +5183,15 @@ namespace ttg_parsec {
       release();
     }
 
-    static void ht_iter_cb(void *item, void *cb_data) {
-      task_t *task = (task_t *)item;
-      ttT *op = (ttT *)cb_data;
-      if constexpr (!ttg::meta::is_void_v<keyT>) {
-        std::cout << "Left over task " << op->get_name() << " " << task->key << std::endl;
-      } else {
-        std::cout << "Left over task " << op->get_name() << std::endl;
-      }
-    }
-
     void print_incomplete_tasks() {
-      parsec_hash_table_for_all(&tasks_table, ht_iter_cb, this);
+      tasks_table.for_all([this](detail::parsec_ttg_task_base_t *item) {
+        task_t *task = static_cast<task_t *>(item);
+        if constexpr (!ttg::meta::is_void_v<keyT>) {
+          std::cout << "Left over task " << get_name() << " " << task->key << std::endl;
+        } else {
+          std::cout << "Left over task " << get_name() << std::endl;
+        }
+      });
     }
 
     virtual void release() override { do_release(); }
@@ -4105,7 +5203,15 @@ namespace ttg_parsec {
       alive = false;
       /* print all outstanding tasks */
       print_incomplete_tasks();
-      parsec_hash_table_fini(&tasks_table);
+      if (detail::task_table_timing) {
+        auto stats = tasks_table.stats();
+        ttg::print(world.rank(), ":", get_name(), ": task table shards ", stats.num_shards, " buckets ",
+                   stats.num_buckets, " inserts ", stats.inserts, " max pending ", stats.max_pending, " max load ",
+                   stats.max_load(), " contended slot locks ", stats.contended_locks, " lock wait ",
+                   stats.lock_wait_time, "s");
+      }
+      tasks_table.fini();
+      constrained_tasks_table.fini();
       parsec_mempool_destruct(&mempools);
       // uintptr_t addr = (uintptr_t)self.incarnations;
       // free((void *)addr);
@@ -4122,6 +5228,7 @@ namespace ttg_parsec {
           self.out[i] = nullptr;
         }
       }
+      detail::op_registry::instance().remove(get_instance_id());
       world.impl().deregister_op(this);
     }
 
@@ -4219,6 +5326,33 @@ namespace ttg_parsec {
       set_static_argstream_size<i>(size);
     }
 
+    /// Enables tree reductions on the streaming input terminal \c i: a contribution that finds another one
+    /// waiting to be reduced is combined with it by the sending thread, so contributions are combined
+    /// pairwise by many threads concurrently and the reducer task only folds the partial results into
+    /// the input of the task. The order in which contributions are combined depends on timing.
+    /// @param value whether to enable tree reductions
+    template <std::size_t i>
+    void set_input_tree_reduction(bool value = true) {
+      assert(std::get<i>(input_reducers) && "TT::set_input_tree_reduction called on nonstreaming input terminal");
+      m_tree_reduction[i] = value && !m_reduction_order[i];
+    }
+
+    /// Makes the reduction on the streaming input terminal \c i reproducible: contributions are buffered
+    /// until the stream is complete, sorted by \c comp, and reduced pairwise in a tree whose shape only
+    /// depends on the number of contributions, right before the task executes. Disables tree reductions.
+    /// @param comp a strict total order on contributions, \c bool(const input_type<i> &, const input_type<i> &)
+    template <std::size_t i, typename Compare>
+    void set_input_reduction_order(Compare &&comp) {
+      using valueT = std::decay_t<std::tuple_element_t<i, input_values_full_tuple_type>>;
+      static_assert(!ttg::meta::is_void_v<valueT> && std::is_copy_constructible_v<valueT>,
+                    "ordered reductions require copyable values");
+      assert(std::get<i>(input_reducers) && "TT::set_input_reduction_order called on nonstreaming input terminal");
+      m_reduction_order[i] = [comp = std::forward<Compare>(comp)](const void *a, const void *b) {
+        return comp(*static_cast<const valueT *>(a), *static_cast<const valueT *>(b));
+      };
+      m_tree_reduction[i] = false;
+    }
+
     // Returns reference to input terminal i to facilitate connection --- terminal
     // cannot be copied, moved or assigned
     template <std::size_t i>
@@ -4346,6 +5480,115 @@ namespace ttg_parsec {
       return m_defer_writer;
     }
 
+    /// Controls whether tasks of this TT may bypass the scheduler: a task made ready by the body
+    /// of a running task is held back and executed by the same thread once that task completes.
+    /// If a task body makes several tasks ready, the last one with the highest priority is held
+    /// and the others are scheduled. The number of tasks inlined on top of each other is bounded
+    /// by \c TTG_MAX_INLINE_DEPTH (6 by default, 0 disables inlining). Disabled by default.
+    /// @param value whether to inline tasks of this TT
+    void set_inlining(bool value) {
+      m_inline = value;
+    }
+
+    /// @return whether tasks of this TT may be executed inline, see set_inlining()
+    bool get_inlining() const {
+      return m_inline;
+    }
+
+    /// Enables coalescing of small remote messages sent to input terminal \c i
+    /// from within a task body. Messages to the same process are accumulated
+    /// up to \c TTG_MAX_AGGREGATION_SIZE bytes (16kB by default) and sent
+    /// together, at the latest when the sending task completes.
+    /// Messages carrying non-inline (RMA) data are never coalesced.
+    template <std::size_t i>
+    void set_aggregation(bool value) {
+      static_assert(i < numins, "TT::set_aggregation: input terminal index out of range");
+      m_aggregate_input[i] = value;
+    }
+
+    /// Enables coalescing of small remote messages for all input terminals, see set_aggregation<i>
+    void set_aggregation(bool value) {
+      m_aggregate_input.fill(value);
+    }
+
+    template <std::size_t i>
+    bool get_aggregation() const {
+      return m_aggregate_input[i];
+    }
+
+    /// Selects tree-based forwarding for broadcasts to input terminal \c i.
+    /// With \c radix > 0 the sender contacts at most \c radix processes, each of which
+    /// receives the data once and forwards it to the processes of its subtree, resulting
+    /// in a tree of depth O(log_radix(P)). A \c radix of 0 (the default) sends directly to all processes.
+    /// \note must be set consistently on all processes
+    template <std::size_t i>
+    void set_broadcast_radix(std::size_t radix) {
+      static_assert(i < numins, "TT::set_broadcast_radix: input terminal index out of range");
+      m_bcast_radix[i] = radix;
+    }
+
+    /// Selects tree-based forwarding for broadcasts to all input terminals, see set_broadcast_radix<i>
+    void set_broadcast_radix(std::size_t radix) {
+      m_bcast_radix.fill(radix);
+    }
+
+    template <std::size_t i>
+    std::size_t get_broadcast_radix() const {
+      return m_bcast_radix[i];
+    }
+
+    /// Sizes the table of tasks waiting for inputs to hold about \c num_pending tasks before it has to grow
+    /// \note must be set before any task of this TT is created
+    void set_task_table_size_hint(std::size_t num_pending) {
+      tasks_table.reserve(num_pending);
+    }
+
+    /// \return the statistics of the table of tasks waiting for inputs
+    /// \note tasks are only counted if the \c TTG_TASK_TABLE_STATS environment variable is set
+    task_table_stats_t get_task_table_stats() const {
+      return tasks_table.stats();
+    }
+
+    /// Keeps the tasks waiting for inputs whose keys are mapped onto [0, size) by \c index in a
+    /// directly-indexed table instead of the hash table, avoiding hashing and bucket locks.
+    /// Keys mapped outside of [0, size) are kept in the hash table.
+    /// \note must be set before any task of this TT is created
+    template <typename IndexFn, typename Key = keyT>
+    std::enable_if_t<!ttg::meta::is_void_v<Key> && std::is_invocable_r_v<std::size_t, IndexFn, const Key&>>
+    set_dense_task_table(std::size_t size, IndexFn &&index) {
+      tasks_table.set_dense(size, std::forward<IndexFn>(index));
+    }
+
+    /// Keeps the tasks waiting for inputs with integral keys in [lo, hi) in a directly-indexed table,
+    /// see set_dense_task_table(size, index)
+    template <typename Key = keyT>
+    std::enable_if_t<std::is_integral_v<Key>> set_dense_task_table(Key lo, Key hi) {
+      assert(lo <= hi);
+      tasks_table.set_dense(hi - lo, [lo](const Key &key) -> std::size_t {
+        return key < lo ? detail::task_table<Key>::npos : static_cast<std::size_t>(key - lo);
+      });
+    }
+
+    /// Keeps the tasks waiting for inputs with \c ttg::MultiIndex keys whose indices are bounded by \c extents
+    /// in a directly-indexed table, see set_dense_task_table(size, index)
+    template <typename Key = keyT>
+    std::enable_if_t<detail::is_multiindex_v<Key>> set_dense_task_table(const Key &extents) {
+      constexpr std::size_t rank = detail::is_multiindex<Key>::rank;
+      std::size_t size = 1;
+      for (std::size_t d = 0; d < rank; ++d) size *= extents[d];
+      tasks_table.set_dense(size, [extents](const Key &key) -> std::size_t {
+        std::size_t idx = 0;
+        for (std::size_t d = 0; d < rank; ++d) {
+          if constexpr (std::is_signed_v<typename detail::is_multiindex<Key>::index_type>) {
+            if (key[d] < 0) return detail::task_table<Key>::npos;
+          }
+          if (key[d] >= extents[d]) return detail::task_table<Key>::npos;
+          idx = idx * extents[d] + key[d];
+        }
+        return idx;
+      });
+    }
+
    public:
     void make_executable() override {
       world.impl().register_tt_profiling(this);
@@ -4461,27 +5704,15 @@ namespace ttg_parsec {
     void register_static_op_function(void) {
       int rank;
       MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-      ttg::trace("ttg_parsec(", rank, ") Inserting into static_id_to_op_map at ", get_instance_id());
+      ttg::trace("ttg_parsec(", rank, ") Inserting into op registry at ", get_instance_id());
       static_set_arg_fct_call_t call = std::make_pair(&TT::static_set_arg, this);
       auto &world_impl = world.impl();
-      static_map_mutex.lock();
-      static_id_to_op_map.insert(std::make_pair(get_instance_id(), call));
-      if (delayed_unpack_actions.count(get_instance_id()) > 0) {
-        auto tp = world_impl.taskpool();
-
-        ttg::trace("ttg_parsec(", rank, ") There are ", delayed_unpack_actions.count(get_instance_id()),
+      auto delayed = detail::op_registry::instance().insert(get_instance_id(), call);
+      if (!delayed.empty()) {
+        ttg::trace("ttg_parsec(", rank, ") There are ", delayed.size(),
                    " messages delayed with op_id ", get_instance_id());
 
-        auto se = delayed_unpack_actions.equal_range(get_instance_id());
-        std::vector<static_set_arg_fct_arg_t> tmp;
-        for (auto it = se.first; it != se.second;) {
-          assert(it->first == get_instance_id());
-          tmp.push_back(it->second);
-          it = delayed_unpack_actions.erase(it);
-        }
-        static_map_mutex.unlock();
-
-        for (auto it : tmp) {
+        for (auto it : delayed) {
           if(ttg::tracing())
             ttg::print("ttg_parsec(", rank, ") Unpacking delayed message (", ", ", get_instance_id(), ", ",
                        std::get<1>(it), ", ", std::get<2>(it), ")");
@@ -4490,10 +5721,6 @@ namespace ttg_parsec {
           assert(rc == 0);
           free(std::get<1>(it));
         }
-
-        tmp.clear();
-      } else {
-        static_map_mutex.unlock();
       }
     }
   };
@@ -1,6 +1,10 @@
 #ifndef TTG_DATA_COPY_H
 #define TTG_DATA_COPY_H
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
 #include <utility>
 #include <limits>
 #include <vector>
@@ -16,6 +20,10 @@
 
 #include "ttg/parsec/thread_local.h"
 #include "ttg/parsec/parsec-ext.h"
+#include "ttg/parsec/memreg_cache.h"
+#include "ttg/serialization/splitmd_data_descriptor.h"
+#include "ttg/util/block_freelist.h"
+#include "ttg/util/footprint.h"
 #include "ttg/util/span.h"
 
 
@@ -89,6 +97,7 @@ namespace ttg_parsec {
         c.m_readers = 0;
         m_refs.store(c.m_refs.load(std::memory_order_relaxed), std::memory_order_relaxed);
         c.m_refs.store(0, std::memory_order_relaxed);
+        invalidate_memregs();
         return *this;
       }
 
@@ -96,12 +105,14 @@ namespace ttg_parsec {
         /* we allow copying but do not copy any data over from the original
          * device copies will have to be allocated again
          * and it's a new object to reference */
-
+        invalidate_memregs();
         return *this;
       }
 
       /* mark destructor as virtual */
-      virtual ~ttg_data_copy_t() = default;
+      virtual ~ttg_data_copy_t() {
+        invalidate_memregs();
+      }
 
       /* Returns true if the copy is mutable */
       bool is_mutable() const {
@@ -111,6 +122,8 @@ namespace ttg_parsec {
       /* Mark the copy as mutable */
       void mark_mutable() {
         m_readers = mutable_tag;
+        /* the value may be modified, and its buffers reallocated at the same address */
+        invalidate_memregs();
       }
 
       /* Increment the reader counter and return previous value
@@ -183,6 +196,22 @@ namespace ttg_parsec {
         return m_refs.load(std::memory_order_relaxed);
       }
 
+      /* Returns a cached memory registration of the region [ptr, ptr+size) owned by this copy,
+       * which is released once the copy is destroyed */
+      std::pair<memreg_cache::handle_t, int32_t> get_memreg(void *ptr, std::size_t size) {
+        m_has_memreg.store(true, std::memory_order_relaxed);
+        return memreg_cache::instance().get(this, ptr, size);
+      }
+
+      /* Drops the cached memory registrations of this copy, must be called whenever
+       * the buffers of the value may have changed. Ongoing transfers keep their registrations alive. */
+      void invalidate_memregs() {
+        if (m_has_memreg.load(std::memory_order_relaxed)) {
+          m_has_memreg.store(false, std::memory_order_relaxed);
+          memreg_cache::instance().evict(this);
+        }
+      }
+
 #if defined(PARSEC_PROF_TRACE) && defined(PARSEC_TTG_PROFILE_BACKEND)
       int64_t size;
       int64_t uid;
@@ -191,6 +220,7 @@ namespace ttg_parsec {
       parsec_task_t *m_next_task = nullptr;
       int32_t        m_readers  = 1;
       std::atomic<int32_t>  m_refs = 1;                     //< number of entities referencing this copy (TTGs, external)
+      std::atomic<bool> m_has_memreg = false;               //< whether the memreg_cache holds registrations of this copy
     };
 
 
@@ -204,6 +234,7 @@ namespace ttg_parsec {
                                        , public ttg_data_copy_t {
       using value_type = ValueT;
       value_type m_value;
+      std::size_t m_footprint = 0; //< number of bytes accounted in ttg::live_data_bytes()
 
       template<typename T>
       requires(std::constructible_from<ValueT, T>)
@@ -214,6 +245,7 @@ namespace ttg_parsec {
       {
         /* reset the container tracker */
         ttg_data_copy_container() = nullptr;
+        account_footprint();
       }
 
       ttg_data_value_copy_t(ttg_data_value_copy_t&& c)
@@ -224,6 +256,7 @@ namespace ttg_parsec {
       {
         /* reset the container tracker */
         ttg_data_copy_container() = nullptr;
+        account_footprint();
       }
 
       ttg_data_value_copy_t(const ttg_data_value_copy_t& c)
@@ -234,6 +267,7 @@ namespace ttg_parsec {
       {
         /* reset the container tracker */
         ttg_data_copy_container() = nullptr;
+        account_footprint();
       }
 
       ttg_data_value_copy_t& operator=(ttg_data_value_copy_t&& c)
@@ -245,6 +279,7 @@ namespace ttg_parsec {
         m_value = std::move(c.m_value);
         /* reset the container tracker */
         ttg_data_copy_container() = nullptr;
+        account_footprint();
       }
 
       ttg_data_value_copy_t& operator=(const ttg_data_value_copy_t& c)
@@ -256,14 +291,54 @@ namespace ttg_parsec {
         m_value = c.m_value;
         /* reset the container tracker */
         ttg_data_copy_container() = nullptr;
+        account_footprint();
       }
 
       value_type& operator*() {
         return m_value;
       }
 
-      /* will destruct the value */
-      virtual ~ttg_data_value_copy_t() = default;
+      /* will destruct the value, or hand it to the recycling pool of its type if it has one */
+      virtual ~ttg_data_value_copy_t() {
+        if (m_footprint > 0) {
+          ttg::detail::live_data_bytes_counter.fetch_sub(m_footprint, std::memory_order_relaxed);
+        }
+        if constexpr (ttg::has_recycling_pool<value_type>::value) {
+          ttg::SplitMetadataDescriptor<value_type> descr;
+          auto metadata = descr.get_metadata(m_value);
+          ttg::recycling_pool<value_type>().release(metadata, std::move(m_value));
+        }
+      }
+
+      /* (re-)accounts the bytes held by the value: the payload of types with split metadata, the size of the object otherwise.
+       * Copies are only accounted while someone measures the live data, see ttg::live_data_bytes() */
+      void account_footprint() {
+        if (0 == m_footprint && !ttg::detail::live_data_bytes_tracked()) return;
+        std::size_t footprint = sizeof(value_type);
+        if constexpr (ttg::has_split_metadata<value_type>::value) {
+          ttg::SplitMetadataDescriptor<value_type> descr;
+          for (auto&& iov : descr.get_data(m_value)) {
+            footprint += iov.num_bytes;
+          }
+        }
+        if (footprint > m_footprint) {
+          ttg::detail::live_data_bytes_counter.fetch_add(footprint - m_footprint, std::memory_order_relaxed);
+        } else {
+          ttg::detail::live_data_bytes_counter.fetch_sub(m_footprint - footprint, std::memory_order_relaxed);
+        }
+        m_footprint = footprint;
+      }
+
+      /* copies are allocated from and released to per-thread freelists,
+       * avoiding a trip to the heap for every value entering the runtime */
+      static void* operator new(std::size_t size) {
+        assert(size == sizeof(ttg_data_value_copy_t));
+        return ttg::detail::block_freelist<sizeof(ttg_data_value_copy_t), alignof(ttg_data_value_copy_t)>::allocate();
+      }
+
+      static void operator delete(void *ptr) {
+        ttg::detail::block_freelist<sizeof(ttg_data_value_copy_t), alignof(ttg_data_value_copy_t)>::deallocate(ptr);
+      }
 
       virtual void* get_ptr() override final {
         return &m_value;
@@ -80,6 +80,17 @@ namespace ttg {
   /// @note This is a collective operation with respect to @p world
   inline void fence(World world = default_execution_context()) { TTG_IMPL_NS::ttg_fence(world); }
 
+  /// Signals that the calling process will not submit more tasks to the given execution context and returns immediately.
+
+  /// @param world  an execution context associated with the default backend
+  /// @return a future that becomes ready when all tasks associated with @p world have finished on all ranks
+  /// @note Dispatches to the `ttg_fence_async` method of the default backend
+  /// @note This is a collective operation with respect to @p world
+  /// @note ttg::fence() must be called before new tasks are submitted to @p world
+  inline std::future<void> fence_async(World world = default_execution_context()) {
+    return TTG_IMPL_NS::ttg_fence_async(world);
+  }
+
   /// @param world an execution context to query the process rank from
   /// @note Calls \c rank() on \c world
   inline int rank(World world = default_execution_context()) { return world.rank(); }
@@ -4,6 +4,7 @@
 #include <type_traits>
 #include "ttg/util/meta.h"
 #include "ttg/util/iovec.h"
+#include "ttg/util/recycling_pool.h"
 
 namespace ttg {
 
@@ -30,6 +31,18 @@ namespace ttg {
    * which returns a collection of \sa ttg::iovec instances
    * describing the payload data to be transferred from the source to the
    * target object.
+   *
+   * Optionally, the descriptor can recycle objects by providing
+   * @code
+   *   auto create_from_metadata(const <metadata_type>& meta, ttg::RecyclingPool<T, <metadata_type>>& pool);
+   * @endcode
+   * instead of (or in addition to) the above. The pool holds objects that the runtime released,
+   * together with their metadata, and returns one matching the requested metadata, e.g.:
+   * @code
+   *   if (auto obj = pool.acquire(meta)) return std::move(*obj);
+   *   return T(meta);
+   * @endcode
+   * The pool of each type can be accessed via ttg::recycling_pool<T>().
    */
   template <typename T>
   struct SplitMetadataDescriptor;
@@ -43,6 +56,33 @@ namespace ttg {
       T, ttg::meta::void_t<decltype(std::declval<SplitMetadataDescriptor<T>>().get_metadata(std::declval<T>()))>>
       : std::true_type {};
 
+  /* the metadata type of a type with split metadata */
+  template <typename T>
+  using split_metadata_t =
+      std::decay_t<decltype(std::declval<SplitMetadataDescriptor<T>>().get_metadata(std::declval<T>()))>;
+
+  /* Trait signalling whether objects are created from metadata using a recycling pool */
+  template <typename T, typename Enabler = void>
+  struct has_recycling_pool : std::false_type {};
+
+  template <typename T>
+  struct has_recycling_pool<
+      T, ttg::meta::void_t<decltype(std::declval<SplitMetadataDescriptor<T>>().create_from_metadata(
+             std::declval<const split_metadata_t<T> &>(), std::declval<RecyclingPool<T, split_metadata_t<T>> &>()))>>
+      : std::true_type {};
+
+  /// @return the pool of released objects of type @c T, see SplitMetadataDescriptor
+  /// @note objects are accounted in the pool by the size of @c T plus the size of their payload
+  template <typename T>
+  RecyclingPool<T, split_metadata_t<T>> &recycling_pool() {
+    static RecyclingPool<T, split_metadata_t<T>> pool([](T &obj) {
+      std::size_t size = sizeof(T);
+      for (auto &&iov : SplitMetadataDescriptor<T>{}.get_data(obj)) size += iov.num_bytes;
+      return size;
+    });
+    return pool;
+  }
+
 }  // namespace ttg
 
 #endif  // TTG_SERIALIZATION_SPLITMD_DATA_DESCRIPTOR_H
@@ -0,0 +1,79 @@
+#ifndef TTG_UTIL_BLOCK_FREELIST_H
+#define TTG_UTIL_BLOCK_FREELIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+namespace ttg {
+
+  namespace detail {
+
+    /* Per-thread cache of freed memory blocks of a given size and alignment.
+     * Blocks are returned to the cache of the thread releasing them, which keeps
+     * at most max_cached blocks (about 1MB, at least one block); surplus blocks
+     * are returned to the heap. */
+    template<std::size_t Size, std::size_t Align>
+    class block_freelist {
+      struct node_t {
+        node_t *next;
+      };
+      static_assert(Size >= sizeof(node_t));
+
+    public:
+      static constexpr std::size_t max_cached = std::clamp<std::size_t>((1UL<<20) / Size, 1, 1024);
+
+      static void* allocate() {
+        if (t_destroyed) {
+          return ::operator new(Size, std::align_val_t{Align});
+        }
+        block_freelist& list = instance();
+        if (nullptr != list.m_head) {
+          node_t *node = list.m_head;
+          list.m_head = node->next;
+          --list.m_size;
+          return node;
+        }
+        return ::operator new(Size, std::align_val_t{Align});
+      }
+
+      static void deallocate(void *ptr) {
+        if (t_destroyed) {
+          /* the thread is exiting */
+          ::operator delete(ptr, std::align_val_t{Align});
+          return;
+        }
+        block_freelist& list = instance();
+        if (list.m_size < max_cached) {
+          list.m_head = new(ptr) node_t{list.m_head};
+          ++list.m_size;
+        } else {
+          ::operator delete(ptr, std::align_val_t{Align});
+        }
+      }
+
+      ~block_freelist() {
+        t_destroyed = true;
+        while (nullptr != m_head) {
+          node_t *node = m_head;
+          m_head = node->next;
+          ::operator delete(node, std::align_val_t{Align});
+        }
+      }
+
+    private:
+      static block_freelist& instance() {
+        static thread_local block_freelist list;
+        return list;
+      }
+
+      static inline thread_local bool t_destroyed = false;
+      node_t *m_head = nullptr;
+      std::size_t m_size = 0;
+    };
+
+  }  // namespace detail
+
+}  // namespace ttg
+
+#endif  // TTG_UTIL_BLOCK_FREELIST_H
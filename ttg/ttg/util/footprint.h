@@ -0,0 +1,37 @@
+#ifndef TTG_UTIL_FOOTPRINT_H
+#define TTG_UTIL_FOOTPRINT_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace ttg {
+
+  namespace detail {
+    /* number of bytes held by the data copies alive in this process, maintained by the backend */
+    inline std::atomic<std::size_t> live_data_bytes_counter = 0;
+
+    /* number of bytes held by the objects kept in recycling pools, see ttg::RecyclingPool */
+    inline std::atomic<std::size_t> pooled_data_bytes_counter = 0;
+
+    /* number of users of ttg::live_data_bytes() (e.g., memory budget constraints), data copies are only
+     * accounted while there is at least one since accounting every copy is not free */
+    inline std::atomic<std::size_t> live_data_bytes_users = 0;
+
+    /* whether data copies created now should be accounted in live_data_bytes_counter */
+    inline bool live_data_bytes_tracked() {
+      return 0 != live_data_bytes_users.load(std::memory_order_relaxed);
+    }
+  }  // namespace detail
+
+  /// @return the number of bytes held by the data copies managed by the runtime that are currently alive in this process,
+  ///         including the objects kept in recycling pools for reuse
+  /// @note data copies are only accounted by backends that manage them (currently PaRSEC), and only while
+  ///       a ttg::MemoryBudgetConstraint measuring the live data exists; copies created before are not accounted
+  inline std::size_t live_data_bytes() {
+    return detail::live_data_bytes_counter.load(std::memory_order_relaxed) +
+           detail::pooled_data_bytes_counter.load(std::memory_order_relaxed);
+  }
+
+}  // namespace ttg
+
+#endif  // TTG_UTIL_FOOTPRINT_H
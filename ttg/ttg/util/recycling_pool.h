@@ -0,0 +1,165 @@
+#ifndef TTG_UTIL_RECYCLING_POOL_H
+#define TTG_UTIL_RECYCLING_POOL_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "ttg/util/footprint.h"
+#include "ttg/util/meta.h"
+#include "ttg/util/hash.h"
+
+namespace ttg {
+
+  /// @brief a thread-safe pool of released objects of type @c T, grouped by their metadata
+  ///
+  /// Objects are released into the pool together with the metadata describing them (e.g., the shape of
+  /// a matrix tile) and can be reacquired later for metadata that compares equal, which avoids reallocating
+  /// their storage. At most capacity() objects are kept per metadata and at most max_bytes() bytes in total,
+  /// surplus objects are destroyed. The bytes held by the pool are included in ttg::live_data_bytes().
+  /// If @c ttg::hash is specialized for @c Metadata the objects are distributed over several independently
+  /// locked shards by the hash of their metadata.
+  /// @tparam T the object type
+  /// @tparam Metadata the metadata type, must be copyable and equality-comparable
+  template <typename T, typename Metadata>
+  class RecyclingPool {
+   public:
+    using value_type = T;
+    using metadata_type = Metadata;
+    /// returns the number of bytes held by an object
+    using size_fn_t = std::function<std::size_t(T &)>;
+
+    /// @param size_fn returns the number of bytes held by an object, @c sizeof(T) by default
+    explicit RecyclingPool(size_fn_t size_fn = [](T &) { return sizeof(T); }) : m_size_fn(std::move(size_fn)) {}
+    RecyclingPool(const RecyclingPool &) = delete;
+    RecyclingPool &operator=(const RecyclingPool &) = delete;
+
+    ~RecyclingPool() { clear(); }
+
+    /// @return an object released with metadata equal to @c meta, or an empty optional if there is none
+    std::optional<T> acquire(const Metadata &meta) {
+      auto &shard = shard_of(meta);
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      auto it = shard.find(meta);
+      if (it == shard.objects.end()) return {};
+      auto &objs = it->second;
+      auto [obj, size] = std::move(objs.back());
+      objs.pop_back();
+      account(-static_cast<std::ptrdiff_t>(size));
+      /* only keep metadata with objects, there may be many distinct metadata over time */
+      if (objs.empty()) shard.erase(it);
+      return std::optional<T>{std::move(obj)};
+    }
+
+    /// Releases an object into the pool, it is dropped if the pool already holds capacity() objects for @c meta
+    /// or keeping it would exceed max_bytes()
+    void release(const Metadata &meta, T &&obj) {
+      std::size_t capacity = m_capacity.load(std::memory_order_relaxed);
+      if (0 == capacity) return;
+      std::size_t size = m_size_fn(obj);
+      auto &shard = shard_of(meta);
+      std::lock_guard<std::mutex> lock(shard.mtx);
+      auto it = shard.find(meta);
+      if (it != shard.objects.end() && it->second.size() >= capacity) return;
+      /* reserve the bytes before inserting so that concurrent releases cannot exceed the limit */
+      if (m_bytes.fetch_add(size, std::memory_order_relaxed) + size > m_max_bytes.load(std::memory_order_relaxed)) {
+        m_bytes.fetch_sub(size, std::memory_order_relaxed);
+        return;
+      }
+      detail::pooled_data_bytes_counter.fetch_add(size, std::memory_order_relaxed);
+      if (it == shard.objects.end()) {
+        it = shard.objects.emplace(shard.objects.end(), meta, std::vector<entry_t>{});
+      }
+      it->second.emplace_back(std::move(obj), size);
+    }
+
+    /// Sets the maximum number of objects kept per metadata, 0 disables recycling
+    void set_capacity(std::size_t capacity) {
+      m_capacity.store(capacity, std::memory_order_relaxed);
+      for (auto &shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        for (auto &[m, objs] : shard.objects) {
+          while (objs.size() > capacity) {
+            account(-static_cast<std::ptrdiff_t>(objs.back().second));
+            objs.pop_back();
+          }
+        }
+        std::erase_if(shard.objects, [](const auto &mo) { return mo.second.empty(); });
+      }
+    }
+
+    /// @return the maximum number of objects kept per metadata
+    std::size_t capacity() const { return m_capacity.load(std::memory_order_relaxed); }
+
+    /// Sets the maximum number of bytes held by the pool, objects beyond it are destroyed when released
+    void set_max_bytes(std::size_t max_bytes) { m_max_bytes.store(max_bytes, std::memory_order_relaxed); }
+
+    /// @return the maximum number of bytes held by the pool
+    std::size_t max_bytes() const { return m_max_bytes.load(std::memory_order_relaxed); }
+
+    /// @return the number of bytes held by the objects in the pool
+    std::size_t bytes() const { return m_bytes.load(std::memory_order_relaxed); }
+
+    /// Destroys all objects held by the pool
+    void clear() {
+      for (auto &shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        for (auto &[m, objs] : shard.objects) {
+          for (auto &entry : objs) account(-static_cast<std::ptrdiff_t>(entry.second));
+        }
+        shard.objects.clear();
+      }
+    }
+
+   private:
+    static constexpr std::size_t num_shards = ttg::meta::has_ttg_hash_specialization_v<Metadata> ? 16 : 1;
+
+    /* an object and the number of bytes it holds */
+    using entry_t = std::pair<T, std::size_t>;
+
+    struct alignas(64) shard_t {
+      std::mutex mtx;
+      /* metadata with at least one object, few are expected per shard so a linear search is fine */
+      std::vector<std::pair<Metadata, std::vector<entry_t>>> objects;
+
+      /* must be called with the mutex held */
+      auto find(const Metadata &meta) {
+        return std::find_if(objects.begin(), objects.end(), [&](const auto &mo) { return mo.first == meta; });
+      }
+
+      /* must be called with the mutex held, does not preserve the order of the metadata */
+      void erase(typename std::vector<std::pair<Metadata, std::vector<entry_t>>>::iterator it) {
+        if (it != objects.end() - 1) *it = std::move(objects.back());
+        objects.pop_back();
+      }
+    };
+
+    shard_t &shard_of(const Metadata &meta) {
+      if constexpr (num_shards > 1) {
+        return m_shards[ttg::hash<Metadata>{}(meta) % num_shards];
+      } else {
+        return m_shards[0];
+      }
+    }
+
+    void account(std::ptrdiff_t size) {
+      m_bytes.fetch_add(size, std::memory_order_relaxed);
+      detail::pooled_data_bytes_counter.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    std::array<shard_t, num_shards> m_shards;
+    size_fn_t m_size_fn;
+    std::atomic<std::size_t> m_bytes = 0;
+    std::atomic<std::size_t> m_capacity = 8;
+    std::atomic<std::size_t> m_max_bytes = 256UL * 1024 * 1024;
+  };
+
+}  // namespace ttg
+
+#endif  // TTG_UTIL_RECYCLING_POOL_H